@@ -0,0 +1,120 @@
+#ifndef ORI_RANDOM_H
+#define ORI_RANDOM_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <random>
+
+namespace Ori {
+
+/** Fast seedable pseudo-random generator (xoshiro256**).
+    A generator object is not thread-safe, every thread should use its own one,
+    so there is nothing to contend on. Use local() to get the generator of the current thread,
+    or make separate generators for independent parts of work (e.g. for chunks of generated data)
+    seeding them by a common seed and the index of the part, then results are reproducible
+    regardless of how the parts are distributed among threads.
+*/
+class Random
+{
+public:
+    explicit Random(quint64 seed = 0) { setSeed(seed); }
+    Random(quint64 seed, quint64 stream) { setSeed(seed, stream); }
+
+    void setSeed(quint64 seed, quint64 stream = 0)
+    {
+        quint64 x = seed ^ mix(stream);
+        for (quint64& s : _s)
+            s = splitMix64(x);
+    }
+
+    quint64 next()
+    {
+        const quint64 result = rotl(_s[1] * 5, 7) * 9;
+        const quint64 t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 45);
+        return result;
+    }
+
+    quint32 next32() { return quint32(next() >> 32); }
+
+    /// Returns a number in range [0, bound).
+    quint32 bounded(quint32 bound) { return quint32((quint64(next32()) * bound) >> 32); }
+
+    /// Returns a number in range [min, max].
+    int bounded(int min, int max) { return min + int(bounded(quint32(max - min + 1))); }
+
+    /// Returns a number in range [0, 1).
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /// Mixes bits of the value, it's a good hash function for integers.
+    static quint64 mix(quint64 value)
+    {
+        return splitMix64(value);
+    }
+
+    /// Returns the generator of the current thread.
+    /// Thread generators are seeded by the global seed and the index of the thread
+    /// (threads are numbered in order of their first call of the function).
+    static Random& local()
+    {
+        static thread_local Random random;
+        static thread_local quint64 generation = 0;
+        static thread_local quint64 threadIndex = nextThreadIndex()++;
+        quint64 current = globalGeneration().load(std::memory_order_acquire);
+        if (generation != current)
+        {
+            generation = current;
+            random.setSeed(globalSeed().load(std::memory_order_relaxed), threadIndex);
+        }
+        return random;
+    }
+
+    /// Reseeds generators of all threads, they take the new seed at their next use.
+    /// Until the seed is set, generators are seeded randomly.
+    static void setGlobalSeed(quint64 seed)
+    {
+        globalSeed().store(seed, std::memory_order_relaxed);
+        globalGeneration().fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    quint64 _s[4];
+
+    static inline quint64 rotl(quint64 x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static quint64 splitMix64(quint64& state)
+    {
+        quint64 z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static std::atomic<quint64>& globalSeed()
+    {
+        static std::atomic<quint64> seed((quint64(std::random_device()()) << 32) ^ std::random_device()());
+        return seed;
+    }
+
+    static std::atomic<quint64>& globalGeneration()
+    {
+        static std::atomic<quint64> generation(1);
+        return generation;
+    }
+
+    static std::atomic<quint64>& nextThreadIndex()
+    {
+        static std::atomic<quint64> index(0);
+        return index;
+    }
+};
+
+} // namespace Ori
+
+#endif // ORI_RANDOM_H
@@ -0,0 +1,338 @@
+#include "OriColorKernels.h"
+
+#include <QAtomicInt>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ORI_COLOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Ori {
+namespace Color {
+
+namespace {
+
+#ifdef ORI_COLOR_SSE2
+QAtomicInt __simdEnabled(1);
+#else
+QAtomicInt __simdEnabled(0);
+#endif
+
+// 8-bit sRGB channel to linear intensity
+const float* linearTable()
+{
+    static const float* table = []{
+        static float t[256];
+        for (int i = 0; i < 256; i++)
+        {
+            double c = i / 255.0;
+            t[i] = float(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline int blendWeight(qreal r)
+{
+    return qRound(qBound(qreal(0), r, qreal(1)) * 256);
+}
+
+// Approximate division by 255 exactly as qPremultiply() does it
+inline uint mulDiv255(uint x, uint a)
+{
+    uint t = x * a;
+    return (t + (t >> 8) + 0x80) >> 8;
+}
+
+void blendScalar(const QRgb* src1, const QRgb* src2, QRgb* dst, int count, int w)
+{
+    const uint w1 = 256 - w, w2 = w;
+    for (int i = 0; i < count; i++)
+    {
+        QRgb p1 = src1[i], p2 = src2[i];
+        uint rb = ((p1 & 0x00FF00FF) * w1 + (p2 & 0x00FF00FF) * w2 + 0x00800080) >> 8;
+        uint ag = (((p1 >> 8) & 0x00FF00FF) * w1 + ((p2 >> 8) & 0x00FF00FF) * w2 + 0x00800080);
+        dst[i] = (rb & 0x00FF00FF) | (ag & 0xFF00FF00);
+    }
+}
+
+void premultiplyScalar(QRgb* pixels, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        QRgb p = pixels[i];
+        uint a = qAlpha(p);
+        pixels[i] = qRgba(mulDiv255(qRed(p), a), mulDiv255(qGreen(p), a), mulDiv255(qBlue(p), a), a);
+    }
+}
+
+inline void rgbToOklab(float r, float g, float b, Oklab& lab)
+{
+    float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+    lab.L = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+    lab.a = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+    lab.b = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+}
+
+void toOklabScalar(const QRgb* src, Oklab* dst, int count)
+{
+    const float* lin = linearTable();
+    for (int i = 0; i < count; i++)
+    {
+        QRgb p = src[i];
+        rgbToOklab(lin[qRed(p)], lin[qGreen(p)], lin[qBlue(p)], dst[i]);
+    }
+}
+
+#ifdef ORI_COLOR_SSE2
+
+// Processes 4 pixels at once: channels are widened to 16 bits, so products fit into lanes
+void blendSse2(const QRgb* src1, const QRgb* src2, QRgb* dst, int count, int w)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w1 = _mm_set1_epi16(short(256 - w));
+    const __m128i w2 = _mm_set1_epi16(short(w));
+    const __m128i bias = _mm_set1_epi16(0x80);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+        __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p1, zero), w1),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(p2, zero), w2));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p1, zero), w1),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(p2, zero), w2));
+        lo = _mm_add_epi16(lo, bias);
+        hi = _mm_add_epi16(hi, bias);
+        __m128i res = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+    }
+    blendScalar(src1 + i, src2 + i, dst + i, count - i, w);
+}
+
+inline __m128i premultiply8(__m128i p, __m128i alphaMask, __m128i bias)
+{
+    // Alpha is spread over the color lanes, the alpha lane itself is multiplied by 255
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    a = _mm_or_si128(_mm_andnot_si128(alphaMask, a), _mm_and_si128(alphaMask, _mm_set1_epi16(255)));
+    __m128i t = _mm_mullo_epi16(p, a);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), bias), 8);
+}
+
+void premultiplySse2(QRgb* pixels, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i bias = _mm_set1_epi16(0x80);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+        __m128i lo = premultiply8(_mm_unpacklo_epi8(p, zero), alphaMask, bias);
+        __m128i hi = premultiply8(_mm_unpackhi_epi8(p, zero), alphaMask, bias);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), _mm_packus_epi16(lo, hi));
+    }
+    premultiplyScalar(pixels + i, count - i);
+}
+
+// Cube root by Newton iterations starting from the exponent divided by 3,
+// three iterations give the full float precision for the range of LMS values
+inline __m128 cbrtPs(__m128 x)
+{
+    const __m128 third = _mm_set1_ps(1.0f / 3.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 tiny = _mm_set1_ps(1e-30f);
+    x = _mm_max_ps(x, tiny);
+    __m128 bits = _mm_cvtepi32_ps(_mm_castps_si128(x));
+    __m128i guess = _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(bits, third)), _mm_set1_epi32(0x2A5137A0));
+    __m128 y = _mm_castsi128_ps(guess);
+    for (int k = 0; k < 3; k++)
+        y = _mm_mul_ps(third, _mm_add_ps(_mm_mul_ps(two, y), _mm_div_ps(x, _mm_mul_ps(y, y))));
+    return y;
+}
+
+inline __m128 dot3(__m128 x, __m128 y, __m128 z, float kx, float ky, float kz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(kx)), _mm_mul_ps(y, _mm_set1_ps(ky))),
+                      _mm_mul_ps(z, _mm_set1_ps(kz)));
+}
+
+void toOklabSse2(const QRgb* src, Oklab* dst, int count)
+{
+    const float* lin = linearTable();
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const QRgb* p = src + i;
+        __m128 r = _mm_set_ps(lin[qRed(p[3])], lin[qRed(p[2])], lin[qRed(p[1])], lin[qRed(p[0])]);
+        __m128 g = _mm_set_ps(lin[qGreen(p[3])], lin[qGreen(p[2])], lin[qGreen(p[1])], lin[qGreen(p[0])]);
+        __m128 b = _mm_set_ps(lin[qBlue(p[3])], lin[qBlue(p[2])], lin[qBlue(p[1])], lin[qBlue(p[0])]);
+        __m128 l = cbrtPs(dot3(r, g, b, 0.4122214708f, 0.5363325363f, 0.0514459929f));
+        __m128 m = cbrtPs(dot3(r, g, b, 0.2119034982f, 0.6806995451f, 0.1073969566f));
+        __m128 s = cbrtPs(dot3(r, g, b, 0.0883024619f, 0.2817188376f, 0.6299787005f));
+        float L[4], A[4], B[4];
+        _mm_storeu_ps(L, dot3(l, m, s, 0.2104542553f, 0.7936177850f, -0.0040720468f));
+        _mm_storeu_ps(A, dot3(l, m, s, 1.9779984951f, -2.4285922050f, 0.4505937099f));
+        _mm_storeu_ps(B, dot3(l, m, s, 0.0259040371f, 0.7827717662f, -0.8086757660f));
+        for (int k = 0; k < 4; k++)
+            dst[i+k] = { L[k], A[k], B[k] };
+    }
+    toOklabScalar(src + i, dst + i, count - i);
+}
+
+#endif // ORI_COLOR_SSE2
+
+inline float hueToRgb(float p, float q, float t)
+{
+    if (t < 0) t += 1;
+    if (t > 1) t -= 1;
+    if (t < 1.0f/6) return p + (q - p) * 6 * t;
+    if (t < 0.5f) return q;
+    if (t < 2.0f/3) return p + (q - p) * (2.0f/3 - t) * 6;
+    return p;
+}
+
+inline int toByte(float c)
+{
+    return qBound(0, int(c * 255 + 0.5f), 255);
+}
+
+} // namespace
+
+bool simdEnabled()
+{
+    return __simdEnabled.load() != 0;
+}
+
+void setSimdEnabled(bool on)
+{
+#ifdef ORI_COLOR_SSE2
+    __simdEnabled.store(on ? 1 : 0);
+#else
+    Q_UNUSED(on)
+#endif
+}
+
+void blend(const QRgb* src1, const QRgb* src2, QRgb* dst, int count, qreal r)
+{
+#ifdef ORI_COLOR_SSE2
+    if (simdEnabled())
+    {
+        blendSse2(src1, src2, dst, count, blendWeight(r));
+        return;
+    }
+#endif
+    blendScalar(src1, src2, dst, count, blendWeight(r));
+}
+
+QImage blend(const QImage& image1, const QImage& image2, qreal r)
+{
+    if (image1.size() != image2.size()) return QImage();
+
+    // Pixels are blended in premultiplied space and unpremultiplied in place when needed
+    bool straight = image1.format() == QImage::Format_ARGB32;
+    QImage img1 = image1.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage img2 = image2.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage result(img1.size(), straight ? QImage::Format_ARGB32 : QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < result.height(); y++)
+    {
+        auto line = reinterpret_cast<QRgb*>(result.scanLine(y));
+        blend(reinterpret_cast<const QRgb*>(img1.constScanLine(y)),
+              reinterpret_cast<const QRgb*>(img2.constScanLine(y)), line, result.width(), r);
+        if (straight)
+            unpremultiply(line, result.width());
+    }
+    return result;
+}
+
+void premultiply(QRgb* pixels, int count)
+{
+#ifdef ORI_COLOR_SSE2
+    if (simdEnabled())
+    {
+        premultiplySse2(pixels, count);
+        return;
+    }
+#endif
+    premultiplyScalar(pixels, count);
+}
+
+void unpremultiply(QRgb* pixels, int count)
+{
+    // There is no vector integer division in SSE2, and a reciprocal
+    // table lookup per pixel is what qUnpremultiply() already does
+    for (int i = 0; i < count; i++)
+        pixels[i] = qUnpremultiply(pixels[i]);
+}
+
+void toHsl(const QRgb* src, Hsl* dst, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        QRgb p = src[i];
+        float r = qRed(p) / 255.0f, g = qGreen(p) / 255.0f, b = qBlue(p) / 255.0f;
+        float max = qMax(r, qMax(g, b));
+        float min = qMin(r, qMin(g, b));
+        float l = (max + min) / 2;
+        float h = 0, s = 0;
+        float d = max - min;
+        if (d > 0)
+        {
+            s = l > 0.5f ? d / (2 - max - min) : d / (max + min);
+            if (max == r)
+                h = (g - b) / d + (g < b ? 6 : 0);
+            else if (max == g)
+                h = (b - r) / d + 2;
+            else
+                h = (r - g) / d + 4;
+            h *= 60;
+        }
+        dst[i] = { h, s, l };
+    }
+}
+
+void fromHsl(const Hsl* src, QRgb* dst, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Hsl& c = src[i];
+        if (c.s <= 0)
+        {
+            int v = toByte(c.l);
+            dst[i] = qRgb(v, v, v);
+            continue;
+        }
+        float h = c.h / 360.0f;
+        float q = c.l < 0.5f ? c.l * (1 + c.s) : c.l + c.s - c.l * c.s;
+        float p = 2 * c.l - q;
+        dst[i] = qRgb(toByte(hueToRgb(p, q, h + 1.0f/3)),
+                      toByte(hueToRgb(p, q, h)),
+                      toByte(hueToRgb(p, q, h - 1.0f/3)));
+    }
+}
+
+void toOklab(const QRgb* src, Oklab* dst, int count)
+{
+#ifdef ORI_COLOR_SSE2
+    if (simdEnabled())
+    {
+        toOklabSse2(src, dst, count);
+        return;
+    }
+#endif
+    toOklabScalar(src, dst, count);
+}
+
+void fromOklab(const Oklab* src, QRgb* dst, int count)
+{
+    for (int i = 0; i < count; i++)
+        dst[i] = fromOklab(src[i]).rgb();
+}
+
+} // namespace Color
+} // namespace Ori
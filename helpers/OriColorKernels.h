@@ -0,0 +1,54 @@
+#ifndef ORI_COLOR_KERNELS_H
+#define ORI_COLOR_KERNELS_H
+
+#include "OriTools.h"
+
+#include <QImage>
+#include <QRgb>
+
+namespace Ori {
+namespace Color {
+
+/** Bulk operations on ARGB32 pixels (QRgb arrays, e.g. scan lines of QImage::Format_ARGB32).
+    Blending, premultiplication and RGB to OKLab conversion are vectorized with SSE2
+    when it's available (always on x86-64), other operations and other platforms
+    use scalar code. Results of both paths are the same except for OKLab conversion,
+    where vectorized code differs by less than 1e-4.
+*/
+
+/// Color in HSL space, h is in range [0, 360), s and l are in range [0, 1].
+struct Hsl
+{
+    float h, s, l;
+};
+
+/// Returns true when vectorized kernels are compiled in and enabled.
+bool simdEnabled();
+
+/// Switches between vectorized and scalar kernels, it's mainly for tests and benchmarks.
+void setSimdEnabled(bool on);
+
+/// Blends premultiplied pixels (e.g. scan lines of QImage::Format_ARGB32_Premultiplied)
+/// including alpha: dst = src1 * (1 - r) + src2 * r, dst can be the same as one of the sources.
+/// Colors must be premultiplied, otherwise colors of transparent pixels leak into the result.
+void blend(const QRgb* src1, const QRgb* src2, QRgb* dst, int count, qreal r);
+
+/// Blends images of the same size in premultiplied space. Returns an ARGB32 image
+/// when the first image is ARGB32, otherwise an ARGB32_Premultiplied image.
+/// Returns a null image if sizes differ.
+QImage blend(const QImage& image1, const QImage& image2, qreal r);
+
+/// Converts pixels in place, the same way as qPremultiply() and qUnpremultiply() do.
+void premultiply(QRgb* pixels, int count);
+void unpremultiply(QRgb* pixels, int count);
+
+void toHsl(const QRgb* src, Hsl* dst, int count);
+void fromHsl(const Hsl* src, QRgb* dst, int count);
+
+void toOklab(const QRgb* src, Oklab* dst, int count);
+void fromOklab(const Oklab* src, QRgb* dst, int count);
+
+} // namespace Color
+} // namespace Ori
+
+#endif // ORI_COLOR_KERNELS_H
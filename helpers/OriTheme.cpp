@@ -1,7 +1,18 @@
+#include "OriTheme.h"
+
 #include <QApplication>
+#include <QCache>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
-#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QWidget>
 
 namespace Ori {
 namespace Theme {
@@ -43,48 +54,619 @@ QString saveRawStyleSheet(const QString& text)
     return QString();
 }
 
+namespace {
+
+QString platformPrefix()
+{
+#if defined(Q_OS_WIN)
+    return QStringLiteral("windows:");
+#elif defined(Q_OS_LINUX)
+    return QStringLiteral("linux:");
+#elif defined(Q_OS_MAC)
+    return QStringLiteral("macos:");
+#else
+    return QString();
+#endif
+}
+
+inline bool isVarStart(QChar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isVarChar(QChar c)
+{
+    return isVarStart(c) || c == '-';
+}
+
+struct StyleSheetTemplate
+{
+    struct Segment
+    {
+        QString text;
+        bool isVar;
+    };
+    QVector<Segment> segments;
+    QHash<QString, QString> vars;
+    int size = 0;
+
+    void addText(const QChar* text, int len)
+    {
+        if (len <= 0) return;
+        if (!segments.isEmpty() && !segments.last().isVar)
+            segments.last().text.append(text, len);
+        else
+            segments.append({QString(text, len), false});
+        size += len;
+    }
+
+    QString varValue(const QString& name, int depth = 0) const
+    {
+        auto it = vars.constFind(name);
+        if (it == vars.constEnd() || depth > 8)
+            return name;
+        if (!it.value().contains('$'))
+            return it.value();
+        // Values can refer to other variables
+        QString value;
+        const QChar* s = it.value().constData();
+        int len = it.value().size();
+        for (int i = 0; i < len; i++)
+        {
+            if (s[i] == '$' && i+1 < len && isVarStart(s[i+1]))
+            {
+                int end = i+2;
+                while (end < len && isVarChar(s[end])) end++;
+                value += varValue(QString(s+i, end-i), depth+1);
+                i = end-1;
+            }
+            else value += s[i];
+        }
+        return value;
+    }
+
+    QString render() const
+    {
+        QString result;
+        result.reserve(size + size/4);
+        for (const Segment& segment : segments)
+            result += segment.isVar ? varValue(segment.text) : segment.text;
+        return result;
+    }
+};
+
+// Splits the stylesheet into literal text and variable references in a single pass.
+// Variable definitions (`$name: value;`) are collected and removed from the text.
+// Lines prefixed with a platform name (`windows:`, `linux:`, `macos:`) are kept
+// without the prefix for the current platform and emptied for other platforms.
+StyleSheetTemplate compileStyleSheet(const QString& raw)
+{
+    static const QString platforms[] = {
+        QStringLiteral("windows:"), QStringLiteral("linux:"), QStringLiteral("macos:")
+    };
+    const QString thisPlatform = platformPrefix();
+
+    StyleSheetTemplate t;
+    const QChar* s = raw.constData();
+    const int len = raw.size();
+    int pos = 0;
+    while (pos < len)
+    {
+        int lineEnd = pos;
+        while (lineEnd < len && s[lineEnd] != '\n') lineEnd++;
+
+        int start = pos;
+        while (start < lineEnd && s[start].isSpace()) start++;
+        for (const QString& platform : platforms)
+        {
+            if (QStringRef(&raw, start, qMin(platform.size(), lineEnd-start)).compare(platform, Qt::CaseInsensitive) != 0)
+                continue;
+            if (platform == thisPlatform)
+            {
+                start += platform.size();
+                pos = start; // the prefix and spaces before it are dropped
+            }
+            else
+                pos = lineEnd; // the line of other platform is emptied
+            break;
+        }
+
+        int textStart = pos;
+        while (pos < lineEnd)
+        {
+            if (s[pos] != '$' || pos+1 >= lineEnd || !isVarStart(s[pos+1]))
+            {
+                pos++;
+                continue;
+            }
+            int nameEnd = pos+2;
+            while (nameEnd < lineEnd && isVarChar(s[nameEnd])) nameEnd++;
+            QString name(s+pos, nameEnd-pos);
+
+            int colon = nameEnd;
+            while (colon < lineEnd && s[colon].isSpace()) colon++;
+            if (colon < lineEnd && s[colon] == ':')
+            {
+                int valueStart = colon+1;
+                while (valueStart < lineEnd && s[valueStart].isSpace()) valueStart++;
+                int valueEnd = lineEnd-1;
+                while (valueEnd > valueStart && s[valueEnd] != ';') valueEnd--;
+                if (valueEnd > valueStart)
+                {
+                    t.addText(s+textStart, pos-textStart);
+                    t.vars[name] = QString(s+valueStart, valueEnd-valueStart);
+                    pos = textStart = valueEnd+1;
+                    continue;
+                }
+            }
+            t.addText(s+textStart, pos-textStart);
+            t.segments.append({name, true});
+            pos = textStart = nameEnd;
+        }
+        t.addText(s+textStart, lineEnd-textStart);
+        if (lineEnd < len)
+            t.addText(s+lineEnd, 1);
+        pos = lineEnd+1;
+    }
+    return t;
+}
+
+} // namespace
+
 QString makeStyleSheet(const QString& rawStyleSheet)
 {
-    QString styleSheet = rawStyleSheet;
+    // Themes are switched back and forth, so compiled stylesheets are remembered
+    static QMutex cacheLock;
+    static QCache<QByteArray, QString> cache(4*1024*1024);
 
-    // Interpolate vars
-    QMap<QString, QString> vars;
-    QRegularExpression varExpr(QStringLiteral("(\\$[a-zA-Z_][a-zA-Z_-]*)\\s*:\\s*(.+);"));
-    auto m = varExpr.match(styleSheet);
-    while (m.hasMatch())
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char*>(rawStyleSheet.constData()), rawStyleSheet.size()*int(sizeof(QChar)));
+    hash.addData(platformPrefix().toLatin1());
+    QByteArray key = hash.result();
+
+    QMutexLocker locker(&cacheLock);
+    QString* cached = cache.object(key);
+    if (cached) return *cached;
+
+    QString styleSheet = compileStyleSheet(rawStyleSheet).render();
+    cache.insert(key, new QString(styleSheet), styleSheet.size());
+    return styleSheet;
+}
+
+namespace {
+
+LoadTimings __lastLoadTimings;
+
+// Should be incremented when the compiler or the format of its output changes,
+// then stylesheets cached by previous versions of the code are not used
+const int __styleSheetCacheVersion = 1;
+
+QString cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/stylesheets");
+}
+
+} // namespace
+
+QString loadStyleSheet()
+{
+    QElapsedTimer timer;
+    timer.start();
+    LoadTimings timings;
+
+    QFile f(resourceName());
+    if (!f.open(QIODevice::ReadOnly))
     {
-        vars[m.captured(1)] = m.captured(2);
-        m = varExpr.match(styleSheet, m.capturedEnd());
+        qWarning() << "Unable to open resource file" << f.fileName() << f.errorString();
+        return QString();
     }
-    styleSheet.remove(varExpr);
-    auto it = vars.constBegin();
-    while (it != vars.constEnd())
+    QByteArray raw = f.readAll();
+    timings.read = timer.nsecsElapsed() / 1000;
+
+    // Cached file is only valid for the same stylesheet processed by the same code.
+    // The file name starts with an id of the resource, so other resources don't clash with it
+    QString resourceId = QString::fromLatin1(QCryptographicHash::hash(
+        resourceName().toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(raw);
+    hash.addData(qVersion());
+    hash.addData(QByteArray::number(__styleSheetCacheVersion));
+    hash.addData(platformPrefix().toLatin1());
+    QDir dir(cacheDir());
+    QString cacheFile = dir.filePath(resourceId + '-' + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".qss"));
+
+    QString styleSheet;
+    QFile cached(cacheFile);
+    if (cached.open(QIODevice::ReadOnly))
     {
-        styleSheet.replace(it.key(), it.value());
-        it++;
+        styleSheet = QString::fromUtf8(cached.readAll());
+        timings.fromCache = true;
+        timings.cache = timer.nsecsElapsed() / 1000 - timings.read;
     }
+    else
+    {
+        qint64 compileStart = timer.nsecsElapsed();
+        styleSheet = makeStyleSheet(QString::fromUtf8(raw));
+        timings.compile = (timer.nsecsElapsed() - compileStart) / 1000;
 
-    // Process platform-dependeent props
-    auto options = QRegularExpression::CaseInsensitiveOption | QRegularExpression::MultilineOption;
-    QRegularExpression propWin(QStringLiteral("^\\s*windows:(.*)$"), options);
-    QRegularExpression propLinux(QStringLiteral("^\\s*linux:(.*)$"), options);
-    QRegularExpression propMacos(QStringLiteral("^\\s*macos:(.*)$"), options);
-#if defined(Q_OS_WIN)
-    styleSheet.replace(propWin, QStringLiteral("\\1"));
-    styleSheet.remove(propLinux);
-    styleSheet.remove(propMacos);
-#elif defined(Q_OS_LINUX)
-    styleSheet.replace(propLinux, QStringLiteral("\\1"));
-    styleSheet.remove(propWin);
-    styleSheet.remove(propMacos);
-#elif defined(Q_OS_MAC)
-    styleSheet.replace(propMacos, QStringLiteral("\\1"));
-    styleSheet.remove(propWin);
-    styleSheet.remove(propLinux);
-#endif
+        // Previous versions of this stylesheet are not needed anymore
+        QString oldFiles = resourceId + QStringLiteral("-*.qss");
+        for (const QString& oldFile : dir.entryList({oldFiles}, QDir::Files))
+            dir.remove(oldFile);
+        dir.mkpath(QStringLiteral("."));
+        QSaveFile file(cacheFile);
+        if (file.open(QIODevice::WriteOnly))
+        {
+            file.write(styleSheet.toUtf8());
+            if (!file.commit())
+                qWarning() << "Unable to write stylesheet cache" << cacheFile << file.errorString();
+        }
+        else
+            qWarning() << "Unable to open stylesheet cache" << cacheFile << file.errorString();
+        timings.cache = (timer.nsecsElapsed() - compileStart) / 1000 - timings.compile;
+    }
 
+    timings.total = timer.nsecsElapsed() / 1000;
+    __lastLoadTimings = timings;
     return styleSheet;
 }
 
+LoadTimings lastLoadTimings()
+{
+    return __lastLoadTimings;
+}
+
+QString loadTimingsReport()
+{
+    const LoadTimings& t = __lastLoadTimings;
+    return QString("Stylesheet loaded %1 in %2 us (read %3 us, cache %4 us, compile %5 us)")
+        .arg(t.fromCache ? "from cache" : "and compiled")
+        .arg(t.total).arg(t.read).arg(t.cache).arg(t.compile);
+}
+
+//------------------------------------------------------------------------------
+//                               Palette
+//------------------------------------------------------------------------------
+
+QMap<QString, QString> styleSheetVars(const QString& rawStyleSheet)
+{
+    auto t = compileStyleSheet(rawStyleSheet);
+    QMap<QString, QString> vars;
+    for (auto it = t.vars.constBegin(); it != t.vars.constEnd(); it++)
+        vars.insert(it.key(), t.varValue(it.key()).trimmed());
+    return vars;
+}
+
+const QMap<QString, QString>& vars()
+{
+    static QMap<QString, QString> vars = QFile::exists(resourceName())
+        ? styleSheetVars(loadRawStyleSheet()) : QMap<QString, QString>();
+    return vars;
+}
+
+QColor parseColor(const QString& value)
+{
+    QString s = value.trimmed();
+    bool rgba = s.startsWith(QStringLiteral("rgba("), Qt::CaseInsensitive);
+    if (rgba || s.startsWith(QStringLiteral("rgb("), Qt::CaseInsensitive))
+    {
+        if (!s.endsWith(')')) return QColor();
+        int start = s.indexOf('(') + 1;
+        auto parts = s.mid(start, s.size()-start-1).split(',');
+        if (parts.size() != (rgba ? 4 : 3)) return QColor();
+        int c[4] = {0, 0, 0, 255};
+        for (int i = 0; i < parts.size(); i++)
+        {
+            bool ok;
+            c[i] = parts.at(i).trimmed().toInt(&ok);
+            if (!ok || c[i] < 0 || c[i] > 255) return QColor();
+        }
+        return QColor(c[0], c[1], c[2], c[3]);
+    }
+    return QColor(s);
+}
+
+QColor color(const QString& var, const QColor& def)
+{
+    auto it = vars().constFind(var);
+    if (it == vars().constEnd()) return def;
+    QColor c = parseColor(it.value());
+    return c.isValid() ? c : def;
+}
+
+QPalette makePalette(const QMap<QString, QString>& vars, const QPalette& base)
+{
+    static const struct { const char* name; QPalette::ColorRole role; } roles[] = {
+        { "window", QPalette::Window },
+        { "window-text", QPalette::WindowText },
+        { "base", QPalette::Base },
+        { "alternate-base", QPalette::AlternateBase },
+        { "tool-tip-base", QPalette::ToolTipBase },
+        { "tool-tip-text", QPalette::ToolTipText },
+        { "text", QPalette::Text },
+        { "button", QPalette::Button },
+        { "button-text", QPalette::ButtonText },
+        { "bright-text", QPalette::BrightText },
+        { "light", QPalette::Light },
+        { "midlight", QPalette::Midlight },
+        { "mid", QPalette::Mid },
+        { "dark", QPalette::Dark },
+        { "shadow", QPalette::Shadow },
+        { "highlight", QPalette::Highlight },
+        { "highlighted-text", QPalette::HighlightedText },
+        { "link", QPalette::Link },
+        { "link-visited", QPalette::LinkVisited },
+    };
+    QPalette palette(base);
+    for (const auto& r : roles)
+    {
+        QColor c = parseColor(vars.value(QStringLiteral("$palette-") % QLatin1String(r.name)));
+        if (c.isValid())
+            palette.setColor(r.role, c);
+        c = parseColor(vars.value(QStringLiteral("$palette-disabled-") % QLatin1String(r.name)));
+        if (c.isValid())
+            palette.setColor(QPalette::Disabled, r.role, c);
+    }
+    return palette;
+}
+
+void setColors(QWidget* widget, const QColor& text, const QColor& background)
+{
+    QPalette p = widget->palette();
+    p.setColor(QPalette::WindowText, text);
+    p.setColor(QPalette::Text, text);
+    if (background.isValid())
+    {
+        p.setColor(QPalette::Window, background);
+        p.setColor(QPalette::Base, background);
+        widget->setAutoFillBackground(true);
+    }
+    widget->setPalette(p);
+}
+
+void resetColors(QWidget* widget)
+{
+    widget->setAutoFillBackground(false);
+    widget->setPalette(QPalette());
+}
+
+PaletteStyle::PaletteStyle(QStyle* style) : PaletteStyle(vars(), style)
+{
+}
+
+PaletteStyle::PaletteStyle(const QMap<QString, QString>& vars, QStyle* style) : QProxyStyle(style)
+{
+    _palette = makePalette(vars, baseStyle()->standardPalette());
+}
+
+QPalette PaletteStyle::standardPalette() const
+{
+    return _palette;
+}
+
+void PaletteStyle::polish(QPalette& palette)
+{
+    palette = _palette;
+}
+
+//------------------------------------------------------------------------------
+//                            StyleSheetReloader
+//------------------------------------------------------------------------------
+
+QMap<QString, QString> StyleSheetReloader::parseRules(const QString& styleSheet)
+{
+    QString text = styleSheet;
+    int pos = 0;
+    while ((pos = text.indexOf(QStringLiteral("/*"), pos)) >= 0)
+    {
+        int end = text.indexOf(QStringLiteral("*/"), pos+2);
+        text.remove(pos, end < 0 ? text.size()-pos : end+2-pos);
+    }
+
+    QMap<QString, QString> rules;
+    pos = 0;
+    while (true)
+    {
+        int open = text.indexOf('{', pos);
+        if (open < 0) break;
+        int close = text.indexOf('}', open);
+        if (close < 0) break;
+        QString body = text.mid(open+1, close-open-1).simplified();
+        for (const QString& s : text.mid(pos, open-pos).split(','))
+        {
+            QString selector = s.simplified();
+            if (selector.isEmpty()) continue;
+            QString& declarations = rules[selector];
+            if (!declarations.isEmpty()) declarations += ' ';
+            declarations += body;
+        }
+        pos = close+1;
+    }
+    return rules;
+}
+
+bool StyleSheetReloader::SelectorTarget::matches(QWidget* w) const
+{
+    if (!className.isEmpty())
+    {
+        if (exactClass ? className != w->metaObject()->className() : !w->inherits(className.constData()))
+            return false;
+    }
+    return objectName.isEmpty() || w->objectName() == objectName;
+}
+
+StyleSheetReloader::SelectorTarget StyleSheetReloader::selectorTarget(const QString& selector)
+{
+    QString compound = selector.mid(qMax(selector.lastIndexOf(' '), selector.lastIndexOf('>')) + 1);
+    auto isNameChar = [](QChar c){ return c.isLetterOrNumber() || c == '_' || c == '-'; };
+
+    SelectorTarget target;
+    int pos = 0;
+    if (compound.startsWith('.'))
+    {
+        target.exactClass = true;
+        pos = 1;
+    }
+    int end = pos;
+    while (end < compound.size() && isNameChar(compound.at(end))) end++;
+    // Namespaced classes are written like `Ori--Widgets--MruMenu` in stylesheets
+    target.className = compound.mid(pos, end-pos).replace(QStringLiteral("--"), QStringLiteral("::")).toLatin1();
+
+    int hash = compound.indexOf('#');
+    if (hash >= 0)
+    {
+        end = hash+1;
+        while (end < compound.size() && isNameChar(compound.at(end))) end++;
+        target.objectName = compound.mid(hash+1, end-hash-1);
+    }
+    return target;
+}
+
+StyleSheetReloader::StyleSheetReloader(QObject* parent) : QObject(parent)
+{
+    _styleSheet = qApp->styleSheet();
+    _applied = parseRules(_styleSheet);
+
+    // Editors can save files in several steps
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    _timer->setInterval(100);
+    connect(_timer, SIGNAL(timeout()), this, SLOT(reload()));
+
+    _watcher = new QFileSystemWatcher(this);
+    _watcher->addPath(rawFileName());
+    connect(_watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged()));
+}
+
+void StyleSheetReloader::fileChanged()
+{
+    _timer->start();
+}
+
+void StyleSheetReloader::reload()
+{
+    // Editors often save files by replacing them, then the watcher loses them
+    if (!_watcher->files().contains(rawFileName()))
+        _watcher->addPath(rawFileName());
+
+    QFile f(rawFileName());
+    if (!f.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Unable to open stylesheet file" << f.fileName() << f.errorString();
+        return;
+    }
+    QString styleSheet = makeStyleSheet(QString::fromUtf8(f.readAll()));
+    if (styleSheet == _styleSheet) return;
+    _styleSheet = styleSheet;
+
+    auto rules = parseRules(styleSheet);
+    QMap<QString, QString> changed;
+    for (auto it = rules.constBegin(); it != rules.constEnd(); it++)
+    {
+        auto applied = _applied.constFind(it.key());
+        if (applied != _applied.constEnd() && applied.value() == it.value())
+            continue;
+        if (!selectorTarget(it.key()).isValid())
+        {
+            applyAll();
+            return;
+        }
+        changed.insert(it.key(), it.value());
+    }
+    // Rules can't be removed by widget stylesheets
+    for (auto it = _applied.constBegin(); it != _applied.constEnd(); it++)
+        if (!rules.contains(it.key()))
+        {
+            applyAll();
+            return;
+        }
+
+    _changed = changed;
+    applyChanged();
+}
+
+void StyleSheetReloader::applyAll()
+{
+    restoreTargets();
+    _changed.clear();
+    _applied = parseRules(_styleSheet);
+    qApp->setStyleSheet(_styleSheet);
+    emit reloaded(-1);
+}
+
+void StyleSheetReloader::applyChanged()
+{
+    QList<SelectorTarget> selectors;
+    QString changedRules;
+    for (auto it = _changed.constBegin(); it != _changed.constEnd(); it++)
+    {
+        selectors << selectorTarget(it.key());
+        changedRules += it.key() % QStringLiteral(" { ") % it.value() % QStringLiteral(" }\n");
+    }
+
+    QSet<QWidget*> matched;
+    for (QWidget* w : QApplication::allWidgets())
+        for (const SelectorTarget& selector : selectors)
+            if (selector.matches(w))
+            {
+                matched.insert(w);
+                break;
+            }
+
+    // Descendants get the rules from stylesheets of their ancestors
+    QSet<QWidget*> widgets;
+    for (QWidget* w : matched)
+    {
+        bool covered = false;
+        for (QWidget* p = w->parentWidget(); p && !covered; p = p->parentWidget())
+            covered = matched.contains(p);
+        if (!covered) widgets.insert(w);
+    }
+
+    for (auto it = _targets.begin(); it != _targets.end(); )
+        if (!widgets.contains(it.key()))
+        {
+            disconnect(it.key(), SIGNAL(destroyed(QObject*)), this, SLOT(targetDestroyed(QObject*)));
+            it.key()->setStyleSheet(it.value());
+            it = _targets.erase(it);
+        }
+        else it++;
+
+    int count = 0;
+    for (QWidget* w : widgets)
+    {
+        if (!_targets.contains(w))
+        {
+            _targets.insert(w, w->styleSheet());
+            connect(w, SIGNAL(destroyed(QObject*)), this, SLOT(targetDestroyed(QObject*)));
+        }
+        const QString& ownStyleSheet = _targets[w];
+        QString styleSheet = changedRules;
+        if (!ownStyleSheet.isEmpty())
+            styleSheet = ownStyleSheet % '\n' % changedRules;
+        if (w->styleSheet() != styleSheet)
+        {
+            w->setStyleSheet(styleSheet);
+            count++;
+        }
+    }
+    emit reloaded(count);
+}
+
+void StyleSheetReloader::restoreTargets()
+{
+    for (auto it = _targets.constBegin(); it != _targets.constEnd(); it++)
+    {
+        disconnect(it.key(), SIGNAL(destroyed(QObject*)), this, SLOT(targetDestroyed(QObject*)));
+        it.key()->setStyleSheet(it.value());
+    }
+    _targets.clear();
+}
+
+void StyleSheetReloader::targetDestroyed(QObject* obj)
+{
+    _targets.remove(static_cast<QWidget*>(obj));
+}
+
 } // namespace Theme
 } // namespace Ori
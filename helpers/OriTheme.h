@@ -1,8 +1,19 @@
 #ifndef ORI_THEME_H
 #define ORI_THEME_H
 
+#include <QColor>
+#include <QMap>
+#include <QObject>
+#include <QPalette>
+#include <QProxyStyle>
 #include <QString>
 
+QT_BEGIN_NAMESPACE
+class QFileSystemWatcher;
+class QTimer;
+class QWidget;
+QT_END_NAMESPACE
+
 // This module supposes that the main application stylesheet file is app.qss
 // Its devtime location is `$$_PRO_FILE_PWD_/src/app.qss`
 // Its runtime location is `:/style/app` (in resources)
@@ -11,9 +22,133 @@ namespace Ori {
 namespace Theme {
 
 QString loadRawStyleSheet();
+QString rawFileName();
 QString saveRawStyleSheet(const QString& text);
 QString makeStyleSheet(const QString& rawStyleSheet);
 
+/// Returns the processed application stylesheet.
+/// The stylesheet is compiled once and stored in the user cache directory,
+/// the next launches load it from there while the resource, Qt version and platform are the same.
+QString loadStyleSheet();
+
+/// Timings of the last loadStyleSheet() call in microseconds.
+struct LoadTimings
+{
+    qint64 read = 0;    // reading of the resource
+    qint64 cache = 0;   // looking up and reading or writing of the cache file
+    qint64 compile = 0; // processing of the raw stylesheet, zero when loaded from cache
+    qint64 total = 0;
+    bool fromCache = false;
+};
+
+LoadTimings lastLoadTimings();
+
+/// Returns timings of the last loadStyleSheet() call formatted for logging.
+QString loadTimingsReport();
+
+/// Returns values of variables defined in the stylesheet, names are given with `$`.
+/// References to other variables are resolved.
+QMap<QString, QString> styleSheetVars(const QString& rawStyleSheet);
+
+/// Returns variables of the application stylesheet, the resource is processed once at first call.
+const QMap<QString, QString>& vars();
+
+/// Returns color given by the variable of the application stylesheet, e.g. `$error-background`,
+/// or the default color when there is no such variable or it's not a color.
+QColor color(const QString& var, const QColor& def = QColor());
+
+/// Converts a stylesheet color value (`#rgb`, `#rrggbb`, `rgb(r,g,b)`, `rgba(r,g,b,a)` or a name).
+QColor parseColor(const QString& value);
+
+/// Returns the base palette with colors given by variables named after color roles,
+/// e.g. `$palette-window`, `$palette-window-text`, `$palette-highlighted-text`.
+/// Variables prefixed by `$palette-disabled-` set colors of the disabled group.
+QPalette makePalette(const QMap<QString, QString>& vars, const QPalette& base);
+
+/// Sets text and background colors of the widget through its palette.
+/// This is a cheap alternative to setting a widget stylesheet for hot spots,
+/// it doesn't install stylesheet style and only repaints the widget.
+/// Note that palette colors can be overridden by rules of the application stylesheet.
+void setColors(QWidget* widget, const QColor& text, const QColor& background = QColor());
+void resetColors(QWidget* widget);
+
+/** Style providing the palette made from variables of the application stylesheet.
+    It gives theme colors to applications or their parts without using stylesheets at all:
+
+        qApp->setStyle(new Ori::Theme::PaletteStyle);
+*/
+class PaletteStyle : public QProxyStyle
+{
+public:
+    explicit PaletteStyle(QStyle* style = nullptr);
+    explicit PaletteStyle(const QMap<QString, QString>& vars, QStyle* style = nullptr);
+
+    QPalette standardPalette() const override;
+    void polish(QPalette& palette) override;
+    using QProxyStyle::polish;
+
+private:
+    QPalette _palette;
+};
+
+/** Dev mode helper applying changes of the raw stylesheet file to the running application.
+    The file is watched, and when it changes, compiled rules are compared with the current ones.
+    Changed rules are applied as widget stylesheets only to widgets whose class or objectName
+    matches selectors of these rules, so there is no repolishing of the whole application.
+    When the difference can't be localized (a rule is removed or a selector matches any widget),
+    the whole stylesheet is applied to the application as usual.
+*/
+class StyleSheetReloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StyleSheetReloader(QObject* parent = nullptr);
+
+    /// Widgets styled by a selector: class (exact for `.QLabel` form) and/or object name.
+    struct SelectorTarget
+    {
+        QByteArray className;
+        bool exactClass = false;
+        QString objectName;
+
+        bool isValid() const { return !className.isEmpty() || !objectName.isEmpty(); }
+        bool matches(QWidget* w) const;
+    };
+
+    /// Returns declarations of the compiled stylesheet by selectors,
+    /// declarations of selectors listed in several rules are joined.
+    static QMap<QString, QString> parseRules(const QString& styleSheet);
+
+    /// Returns widgets denoted by the last compound selector,
+    /// e.g. `QToolButton#run:hover` in `QToolBar > QToolButton#run:hover`.
+    static SelectorTarget selectorTarget(const QString& selector);
+
+public slots:
+    /// Applies the whole current stylesheet to the application.
+    void applyAll();
+
+signals:
+    /// Emitted after changes are applied, -1 means the whole application has been repolished.
+    void reloaded(int widgetCount);
+
+private:
+    QFileSystemWatcher* _watcher;
+    QTimer* _timer;
+    QString _styleSheet;              // compiled stylesheet of the file
+    QMap<QString, QString> _applied;  // selector -> declarations applied to the application
+    QMap<QString, QString> _changed;  // selector -> declarations applied to widgets
+    QMap<QWidget*, QString> _targets; // widget -> its own stylesheet
+
+    void applyChanged();
+    void restoreTargets();
+
+private slots:
+    void fileChanged();
+    void reload();
+    void targetDestroyed(QObject* obj);
+};
+
 } // namespace Theme
 } // namespace Ori
 
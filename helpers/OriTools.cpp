@@ -1,12 +1,16 @@
 #include "OriTools.h"
 
+#include "../core/OriRandom.h"
+
 #include <QUrl>
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
 #include <QUrlQuery>
 #endif
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-#include <QRandomGenerator>
-#endif
+#include <QtMath>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 //--------------------------------------------------------------------------------------------------
 
@@ -35,26 +39,189 @@ int getParamInt(const QUrl& url, const QString& name)
 namespace Ori {
 namespace Color {
 
+namespace {
+
+const char __hexDigits[] = "0123456789abcdef";
+
+inline void writeHex(char*& p, int v)
+{
+    *p++ = __hexDigits[(v >> 4) & 0xF];
+    *p++ = __hexDigits[v & 0xF];
+}
+
+// Writes a number in range [-999, 999]
+inline void writeInt(char*& p, int v)
+{
+    if (v < 0) *p++ = '-', v = -v;
+    if (v >= 100) *p++ = char('0' + v / 100);
+    if (v >= 10) *p++ = char('0' + v / 10 % 10);
+    *p++ = char('0' + v % 10);
+}
+
+int formatTriple(char* buf, const char* prefix, int v1, int v2, int v3)
+{
+    char* p = buf;
+    for (int i = 0; i < 3; i++) *p++ = prefix[i];
+    *p++ = '(';
+    // Only hue can be negative, it's -1 for achromatic colors
+    writeInt(p, qBound(-1, v1, 999)); *p++ = ','; *p++ = ' ';
+    writeInt(p, qBound(0, v2, 999)); *p++ = ','; *p++ = ' ';
+    writeInt(p, qBound(0, v3, 999));
+    *p++ = ')';
+    return int(p - buf);
+}
+
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline void skipSpaces(const char*& p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+// Parses "(v1, v2, v3)" after the prefix
+bool parseTriple(const char* p, const char* end, int* values)
+{
+    skipSpaces(p, end);
+    if (p == end || *p++ != '(') return false;
+    for (int i = 0; i < 3; i++)
+    {
+        skipSpaces(p, end);
+        bool negative = p < end && *p == '-';
+        if (negative) p++;
+        int v = 0, digits = 0;
+        while (p < end && *p >= '0' && *p <= '9' && digits < 4)
+            v = v * 10 + (*p++ - '0'), digits++;
+        if (digits == 0) return false;
+        values[i] = negative ? -v : v;
+        skipSpaces(p, end);
+        if (p == end || *p++ != (i < 2 ? ',' : ')')) return false;
+    }
+    skipSpaces(p, end);
+    return p == end;
+}
+
+} // namespace
+
 QString formatHtml(const QColor& c)
 {
-    return QString("#%1%2%3")
-            .arg(QString::number(c.red(), 16), 2, '0')
-            .arg(QString::number(c.green(), 16), 2, '0')
-            .arg(QString::number(c.blue(), 16), 2, '0');
+    char buf[MaxFormattedLength];
+    return QString::fromLatin1(buf, formatHtml(c.rgb(), buf));
 }
 
 QString formatRgb(const QColor& c)
 {
-    int R, G, B;
-    c.getRgb(&R, &G, &B);
-    return QString("rgb(%1, %2, %3)").arg(R).arg(G).arg(B);
+    char buf[MaxFormattedLength];
+    return QString::fromLatin1(buf, formatRgb(c.rgb(), buf));
 }
 
 QString formatHsl(const QColor& c)
 {
+    char buf[MaxFormattedLength];
     int H, S, L;
     c.getHsl(&H, &S, &L);
-    return QString("hsl(%1, %2, %3)").arg(H).arg(S).arg(L);
+    return QString::fromLatin1(buf, formatTriple(buf, "hsl", H, S, L));
+}
+
+int formatHtml(QRgb c, char* buf)
+{
+    char* p = buf;
+    *p++ = '#';
+    writeHex(p, qRed(c));
+    writeHex(p, qGreen(c));
+    writeHex(p, qBlue(c));
+    return int(p - buf);
+}
+
+int formatRgb(QRgb c, char* buf)
+{
+    return formatTriple(buf, "rgb", qRed(c), qGreen(c), qBlue(c));
+}
+
+int formatHsl(QRgb c, char* buf)
+{
+    int H, S, L;
+    QColor(c).getHsl(&H, &S, &L);
+    return formatTriple(buf, "hsl", H, S, L);
+}
+
+bool parse(const char* text, int len, QRgb& c)
+{
+    const char* p = text;
+    const char* end = text + len;
+    skipSpaces(p, end);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    if (end - p < 4) return false;
+
+    if (*p == '#')
+    {
+        if (end - p != 7) return false;
+        int v[6];
+        for (int i = 0; i < 6; i++)
+            if ((v[i] = hexValue(p[i+1])) < 0) return false;
+        c = qRgb(v[0] * 16 + v[1], v[2] * 16 + v[3], v[4] * 16 + v[5]);
+        return true;
+    }
+
+    int v[3];
+    if (qstrncmp(p, "rgb", 3) == 0)
+    {
+        if (!parseTriple(p + 3, end, v)) return false;
+        if (v[0] < 0 || v[1] < 0 || v[2] < 0 || v[0] > 255 || v[1] > 255 || v[2] > 255) return false;
+        c = qRgb(v[0], v[1], v[2]);
+        return true;
+    }
+    if (qstrncmp(p, "hsl", 3) == 0)
+    {
+        if (!parseTriple(p + 3, end, v)) return false;
+        if (v[0] < -1 || v[1] < 0 || v[2] < 0 || v[0] > 359 || v[1] > 255 || v[2] > 255) return false;
+        c = QColor::fromHsl(v[0], v[1], v[2]).rgb();
+        return true;
+    }
+    return false;
+}
+
+int format(const QRgb* colors, int count, char* buf, TextFormat textFormat, char separator)
+{
+    char* p = buf;
+    for (int i = 0; i < count; i++)
+    {
+        switch (textFormat)
+        {
+        case HtmlText: p += formatHtml(colors[i], p); break;
+        case RgbText: p += formatRgb(colors[i], p); break;
+        case HslText: p += formatHsl(colors[i], p); break;
+        }
+        *p++ = separator;
+    }
+    return int(p - buf);
+}
+
+int parse(const char* text, int len, QRgb* colors, int maxCount, char separator, int* consumed)
+{
+    const char* p = text;
+    const char* end = text + len;
+    int count = 0;
+    while (p < end && count < maxCount)
+    {
+        const char* next = static_cast<const char*>(memchr(p, separator, size_t(end - p)));
+        const char* entryEnd = next ? next : end;
+        const char* s = p;
+        while (s < entryEnd && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+        if (s < entryEnd)
+        {
+            if (!parse(p, int(entryEnd - p), colors[count])) break;
+            count++;
+        }
+        p = next ? next + 1 : end;
+    }
+    if (consumed) *consumed = int(p - text);
+    return count;
 }
 
 QColor blend(const QColor& color1, const QColor& color2, qreal r)
@@ -65,38 +232,167 @@ QColor blend(const QColor& color1, const QColor& color2, qreal r)
                   255);
 }
 
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-namespace {
-inline int qrand() {
-    return QRandomGenerator::global()->generate();
-}
+QColor random()
+{
+    return random(Random::local());
 }
-#endif
 
-QColor random()
+QColor random(Random& rnd)
 {
-    return QColor(qrand() % 255, qrand() % 255, qrand() % 255);
+    int r = rnd.bounded(255);
+    int g = rnd.bounded(255);
+    int b = rnd.bounded(255);
+    return QColor(r, g, b);
 }
 
 QColor random(int darkenThan, int lightenThan, int minDistance)
 {
-    static int prevH = 0, prevS = 0, prevL = 0;
+    static thread_local QColor previous;
+    return random(Random::local(), darkenThan, lightenThan, minDistance, previous);
+}
+
+QColor random(Random& rnd, int darkenThan, int lightenThan, int minDistance, QColor& previous)
+{
+    // The previous color is made by QColor::fromHsl, so it returns exactly the same components
+    int prevH = previous.hslHue(), prevS = previous.hslSaturation(), prevL = previous.lightness();
+    if (!previous.isValid()) minDistance = 0;
+    int minL = qBound(0, lightenThan, 254);
+    int maxL = qBound(minL, darkenThan, 254);
     int H, S, L, tryCount = 0;
     while (tryCount++ < 100)
     {
-        H = qrand() % 255;
-        S = qrand() % 255;
-        L = qrand() % 255;
-        if (L < lightenThan) continue;
-        if (L > darkenThan) continue;
+        // Lightness is taken right from the range, so only distance can make a retry
+        H = rnd.bounded(255);
+        S = rnd.bounded(255);
+        L = rnd.bounded(minL, maxL);
         if (qAbs(H - prevH) < minDistance &&
             qAbs(S - prevS) < minDistance &&
             qAbs(L - prevL) < minDistance)
             continue;
         break;
     }
-    prevH = H, prevS = S, prevL = L;
-    return QColor::fromHsl(H, S, L);
+    previous = QColor::fromHsl(H, S, L);
+    return previous;
+}
+
+// OKLab conversions are from https://bottosson.github.io/posts/oklab/
+
+namespace {
+
+inline double toLinear(double c)
+{
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+inline double fromLinear(double c)
+{
+    return c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+}
+
+// Returns false when the color is out of sRGB gamut
+bool oklabToRgb(const Oklab& c, double& r, double& g, double& b)
+{
+    double l = c.L + 0.3963377774 * c.a + 0.2158037573 * c.b;
+    double m = c.L - 0.1055613458 * c.a - 0.0638541728 * c.b;
+    double s = c.L - 0.0894841775 * c.a - 1.2914855480 * c.b;
+    l = l*l*l, m = m*m*m, s = s*s*s;
+    r = fromLinear(+4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s);
+    g = fromLinear(-1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s);
+    b = fromLinear(-0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s);
+    const double eps = 1e-9;
+    return r >= -eps && r <= 1+eps && g >= -eps && g <= 1+eps && b >= -eps && b <= 1+eps;
+}
+
+inline double squaredDistance(const Oklab& c1, const Oklab& c2)
+{
+    double dL = c1.L - c2.L, da = c1.a - c2.a, db = c1.b - c2.b;
+    return dL*dL + da*da + db*db;
+}
+
+} // namespace
+
+Oklab toOklab(const QColor& c)
+{
+    double r = toLinear(c.redF());
+    double g = toLinear(c.greenF());
+    double b = toLinear(c.blueF());
+    double l = std::cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+    double m = std::cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+    double s = std::cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+    return {
+        0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s,
+        1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s,
+        0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s
+    };
+}
+
+QColor fromOklab(const Oklab& c)
+{
+    double r, g, b;
+    oklabToRgb(c, r, g, b);
+    return QColor::fromRgbF(qBound(0.0, r, 1.0), qBound(0.0, g, 1.0), qBound(0.0, b, 1.0));
+}
+
+double distance(const Oklab& c1, const Oklab& c2)
+{
+    return std::sqrt(squaredDistance(c1, c2));
+}
+
+QVector<QColor> palette(int count, const PaletteOptions& options)
+{
+    QVector<QColor> result;
+    if (count <= 0) return result;
+
+    int poolSize = options.candidates > 0 ? options.candidates : qMax(1024, count * 32);
+    poolSize = qMax(poolSize, count);
+
+    // Candidates are taken uniformly from the requested lightness-chroma band,
+    // colors out of gamut are skipped. The number of attempts is limited,
+    // and if the band is too narrow, the pool is topped up with clamped colors
+    Random rnd(options.seed);
+    QVector<QColor> colors;
+    QVector<Oklab> pool;
+    colors.reserve(poolSize);
+    pool.reserve(poolSize);
+    const double minL = qMin(options.minLightness, options.maxLightness);
+    const double maxL = qMax(options.minLightness, options.maxLightness);
+    const double minC = qMin(options.minChroma, options.maxChroma);
+    const double maxC = qMax(options.minChroma, options.maxChroma);
+    for (int attempt = 0; attempt < poolSize * 8 && pool.size() < poolSize; attempt++)
+    {
+        bool lastChance = attempt >= poolSize * 8 - (poolSize - pool.size());
+        double L = minL + rnd.nextDouble() * (maxL - minL);
+        double C = minC + rnd.nextDouble() * (maxC - minC);
+        double h = rnd.nextDouble() * 2 * M_PI;
+        Oklab lab { L, C * std::cos(h), C * std::sin(h) };
+        double r, g, b;
+        if (!oklabToRgb(lab, r, g, b) && !lastChance) continue;
+        QColor color = QColor::fromRgbF(qBound(0.0, r, 1.0), qBound(0.0, g, 1.0), qBound(0.0, b, 1.0));
+        colors << color;
+        pool << toOklab(color);
+    }
+
+    // Farthest-point sampling: the squared distance from each candidate to the nearest
+    // chosen color is kept up to date, so each step is a single pass over the pool
+    QVector<double> nearest(pool.size(), std::numeric_limits<double>::max());
+    auto updateNearest = [&](const Oklab& chosen) {
+        for (int i = 0; i < pool.size(); i++)
+            nearest[i] = qMin(nearest.at(i), squaredDistance(pool.at(i), chosen));
+    };
+    for (const QColor& c : options.avoid)
+        updateNearest(toOklab(c));
+
+    result.reserve(count);
+    while (result.size() < count)
+    {
+        int best = 0;
+        for (int i = 1; i < pool.size(); i++)
+            if (nearest.at(i) > nearest.at(best))
+                best = i;
+        result << colors.at(best);
+        updateNearest(pool.at(best));
+    }
+    return result;
 }
 
 } // namespace Color
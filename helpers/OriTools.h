@@ -3,6 +3,7 @@
 
 #include <QColor>
 #include <QString>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QUrl;
@@ -22,15 +23,79 @@ int getParamInt(const QUrl& url, const QString& name);
 //--------------------------------------------------------------------------------------------------
 
 namespace Ori {
+
+class Random;
+
 namespace Color {
 
 QString formatHtml(const QColor& c);
 QString formatRgb(const QColor& c);
 QString formatHsl(const QColor& c);
+
+/// Maximal length of text written by format functions, e.g. "rgb(255, 255, 255)".
+const int MaxFormattedLength = 18;
+
+/// Write color text into the buffer, which must have room for MaxFormattedLength chars.
+/// Text is not null-terminated, functions return its length. They don't allocate memory.
+int formatHtml(QRgb c, char* buf);
+int formatRgb(QRgb c, char* buf);
+int formatHsl(QRgb c, char* buf);
+
+/// Parses "#rrggbb", "rgb(r, g, b)" or "hsl(h, s, l)" text of given length
+/// (the same forms as written by format functions). Returns false if the text is invalid.
+bool parse(const char* text, int len, QRgb& c);
+
+enum TextFormat { HtmlText, RgbText, HslText };
+
+/// Writes texts of colors followed by the separator (e.g. a line per color) without memory allocation.
+/// The buffer must have room for count * (MaxFormattedLength + 1) chars. Returns the number of written chars.
+int format(const QRgb* colors, int count, char* buf, TextFormat textFormat = HtmlText, char separator = '\n');
+
+/// Parses texts of colors separated by the separator, empty entries are skipped.
+/// Any form accepted by parse() can be used. Parsing stops at the first invalid entry
+/// or when `maxCount` colors are parsed. Returns the number of parsed colors,
+/// `consumed` receives the number of processed chars.
+int parse(const char* text, int len, QRgb* colors, int maxCount, char separator = '\n', int* consumed = nullptr);
 QColor blend(const QColor& color1, const QColor& color2, qreal r);
 QColor random();
+QColor random(Random& rnd);
 QColor random(int darkenThan, int lightenThan, int minDistance);
 
+/// Returns a random color with HSL lightness in range [lightenThan, darkenThan] which differs
+/// from `previous` by at least `minDistance` in some of HSL components (when it's possible).
+/// `previous` receives the returned color, so a sequence of colors is made by passing the same variable.
+/// It's invalid at the start of a sequence and then there is no distance check.
+QColor random(Random& rnd, int darkenThan, int lightenThan, int minDistance, QColor& previous);
+
+/// Color in OKLab perceptual space, L is in range [0, 1], a and b are roughly in [-0.4, 0.4].
+/// Euclidean distance between OKLab colors is close to the perceived difference between them.
+struct Oklab
+{
+    double L, a, b;
+};
+
+Oklab toOklab(const QColor& c);
+QColor fromOklab(const Oklab& c); ///< Colors out of sRGB gamut are clamped
+double distance(const Oklab& c1, const Oklab& c2);
+
+struct PaletteOptions
+{
+    double minLightness = 0.45;  ///< OKLab lightness range of palette colors
+    double maxLightness = 0.85;
+    double minChroma = 0.06;     ///< Excludes grayish colors
+    double maxChroma = 0.3;
+    int candidates = 0;          ///< Size of the candidate pool, 0 means 32 per color but not less than 1024
+    quint64 seed = 0;
+    QVector<QColor> avoid;       ///< Colors to be far from, e.g. background and text colors
+};
+
+/// Returns `count` well separated colors. Colors are chosen from a pool of random candidates
+/// by farthest-point sampling in OKLab space: every next color is the candidate farthest
+/// from all colors chosen before (and from avoided ones), so any first colors of the palette
+/// are well separated as well. It takes O(count * candidates) time,
+/// and the same options always give the same palette.
+QVector<QColor> palette(int count, const PaletteOptions& options = PaletteOptions());
+
 } // namespace Color
 } // namespace Ori
 
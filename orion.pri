@@ -40,12 +40,15 @@ HEADERS += \
     $$PWD/widgets/OriStylesMenu.h \
     $$PWD/widgets/OriValueEdit.h \
     $$PWD/tools/OriDebug.h \
+    $$PWD/tools/OriMessageIndex.h \
     $$PWD/tools/OriLoremIpsum.h \
     $$PWD/tools/OriSettings.h \
+    $$PWD/tools/OriSettingsSchema.h \
     $$PWD/tools/OriStyler.h \
     $$PWD/tools/OriTranslator.h \
     $$PWD/tools/OriWaitCursor.h \
     $$PWD/tools/OriMruList.h \
+    $$PWD/tools/OriFuzzyIndex.h \
     $$PWD/tools/OriLog.h \
     $$PWD/helpers/OriWidgets.h \
     $$PWD/helpers/OriWindows.h \
@@ -55,10 +58,12 @@ HEADERS += \
     $$PWD/core/OriVersion.h \
     $$PWD/dialogs/OriBasicConfigDlg.h \
     $$PWD/helpers/OriTools.h \
+    $$PWD/helpers/OriColorKernels.h \
     $$PWD/widgets/OriBackWidget.h \
     $$PWD/widgets/OriTableWidgetBase.h \
     $$PWD/widgets/OriFlowLayout.h \
     $$PWD/core/OriFilter.h \
+    $$PWD/core/OriRandom.h \
     $$PWD/helpers/OriLayouts.h
 
 SOURCES += \
@@ -83,12 +88,15 @@ SOURCES += \
     $$PWD/tools/OriStyler.cpp \
     $$PWD/tools/OriTranslator.cpp \
     $$PWD/tools/OriMruList.cpp \
+    $$PWD/tools/OriFuzzyIndex.cpp \
     $$PWD/tools/OriLog.cpp \
+    $$PWD/tools/OriMessageIndex.cpp \
     $$PWD/helpers/OriWidgets.cpp \
     $$PWD/helpers/OriWindows.cpp \
     $$PWD/helpers/OriDialogs.cpp \
     $$PWD/dialogs/OriBasicConfigDlg.cpp \
     $$PWD/helpers/OriTools.cpp \
+    $$PWD/helpers/OriColorKernels.cpp \
     $$PWD/widgets/OriBackWidget.cpp \
     $$PWD/widgets/OriTableWidgetBase.cpp \
     $$PWD/widgets/OriFlowLayout.cpp
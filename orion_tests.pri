@@ -5,4 +5,18 @@ SOURCES += \
     $$PWD/tests/ori_test_Templates.cpp \
     $$PWD/tests/ori_test_Version.cpp \
     $$PWD/tests/ori_test_Filter.cpp \
-    $$PWD/tests/ori_test_Math.cpp
+    $$PWD/tests/ori_test_Math.cpp \
+    $$PWD/tests/ori_test_MessageIndex.cpp \
+    $$PWD/tests/ori_test_FuzzyIndex.cpp \
+    $$PWD/tests/ori_test_MruList.cpp \
+    $$PWD/tests/ori_test_MruMenu.cpp \
+    $$PWD/tests/ori_test_Theme.cpp \
+    $$PWD/tests/ori_test_Petname.cpp \
+    $$PWD/tests/ori_test_LoremIpsum.cpp \
+    $$PWD/tests/ori_test_Random.cpp \
+    $$PWD/tests/ori_test_SyntheticModel.cpp \
+    $$PWD/tests/ori_test_Color.cpp \
+    $$PWD/tests/ori_test_Styler.cpp \
+    $$PWD/tests/ori_test_Settings.cpp \
+    $$PWD/tests/ori_test_StatusBar.cpp \
+    $$PWD/tests/ori_test_Benchmarks.cpp
@@ -0,0 +1,142 @@
+#include "OriSyntheticModel.h"
+
+#include "../core/OriRandom.h"
+#include "../helpers/OriTools.h"
+#include "../tools/OriLoremIpsum.h"
+#include "../tools/OriPetname.h"
+
+#include <QColor>
+#include <QDate>
+
+namespace Ori {
+namespace Testing {
+
+namespace {
+
+const char* __typeNames[] = {
+    "id", "int", "double", "bool", "word", "words", "text", "name", "email", "color", "date"
+};
+const int __typeCount = sizeof(__typeNames) / sizeof(__typeNames[0]);
+
+bool isNumeric(SyntheticModel::ColumnType type)
+{
+    return type == SyntheticModel::Id || type == SyntheticModel::Int || type == SyntheticModel::Double;
+}
+
+} // namespace
+
+SyntheticModel::SyntheticModel(int rows, const QVector<Column>& columns, quint64 seed, QObject* parent)
+    : QAbstractTableModel(parent), _rows(qMax(rows, 0)), _columns(columns), _seed(seed)
+{
+}
+
+SyntheticModel* SyntheticModel::create(int rows, const QString& columns, quint64 seed, QObject* parent)
+{
+    QVector<Column> cols;
+    for (const QString& name : columns.split(','))
+    {
+        QString title = name.trimmed();
+        if (!title.isEmpty())
+            cols.append({ columnType(title), title });
+    }
+    return new SyntheticModel(rows, cols, seed, parent);
+}
+
+SyntheticModel::ColumnType SyntheticModel::columnType(const QString& name)
+{
+    for (int i = 0; i < __typeCount; i++)
+        if (name.compare(QLatin1String(__typeNames[i]), Qt::CaseInsensitive) == 0)
+            return ColumnType(i);
+    return Word;
+}
+
+void SyntheticModel::setRowCount(int rows)
+{
+    beginResetModel();
+    _rows = qMax(rows, 0);
+    endResetModel();
+}
+
+QVariant SyntheticModel::value(int row, int column) const
+{
+    if (row < 0 || row >= _rows || column < 0 || column >= _columns.size())
+        return QVariant();
+
+    // Cells of a row are independent streams keyed by the column index,
+    // so appending columns doesn't change values of the existing ones.
+    // The seed and the row are mixed separately, so different seeds don't share rows.
+    Random rnd(Random::mix(_seed) ^ Random::mix(quint64(row) + 1), quint64(column));
+    switch (_columns.at(column).type)
+    {
+    case Id: return row + 1;
+    case Int: return int(rnd.bounded(1000000));
+    case Double: return rnd.nextDouble() * 1000;
+    case Bool: return rnd.bounded(2) == 1;
+    case Word: return LoremIpsum::makeWords(1, LoremIpsum::None, rnd);
+    case Words: return LoremIpsum::makeWords(2 + rnd.bounded(4), LoremIpsum::FirstCapital, rnd);
+    case Text: return LoremIpsum::makeWords(10 + rnd.bounded(30), LoremIpsum::FirstCapital, rnd);
+    case Name: return OriPetname::make(2, ' ', rnd);
+    case Email: return LoremIpsum::makeEmail(rnd);
+    case Color: return Ori::Color::random(rnd);
+    case Date: return QDate(2000, 1, 1).addDays(rnd.bounded(10000));
+    }
+    return QVariant();
+}
+
+int SyntheticModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _rows;
+}
+
+int SyntheticModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _columns.size();
+}
+
+QVariant SyntheticModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+
+    ColumnType type = _columns.at(index.column()).type;
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        if (type == Bool) return QVariant();
+        if (type == Color) return Ori::Color::formatHtml(value(index.row(), index.column()).value<QColor>());
+        return value(index.row(), index.column());
+
+    case Qt::DecorationRole:
+        if (type == Color) return value(index.row(), index.column());
+        break;
+
+    case Qt::CheckStateRole:
+        if (type == Bool) return value(index.row(), index.column()).toBool() ? Qt::Checked : Qt::Unchecked;
+        break;
+
+    case Qt::TextAlignmentRole:
+        if (isNumeric(type)) return int(Qt::AlignRight | Qt::AlignVCenter);
+        break;
+    }
+    return QVariant();
+}
+
+QVariant SyntheticModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Vertical) return section + 1;
+    if (section < 0 || section >= _columns.size()) return QVariant();
+    return _columns.at(section).title;
+}
+
+bool SyntheticModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role)
+{
+    if (orientation != Qt::Horizontal || (role != Qt::EditRole && role != Qt::DisplayRole)) return false;
+    if (section < 0 || section >= _columns.size()) return false;
+    _columns[section].title = value.toString();
+    emit headerDataChanged(orientation, section, section);
+    return true;
+}
+
+} // namespace Testing
+} // namespace Ori
@@ -0,0 +1,61 @@
+#ifndef ORI_SYNTHETIC_MODEL_H
+#define ORI_SYNTHETIC_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+namespace Ori {
+namespace Testing {
+
+/** Table model of random data for benchmarking views, proxies and delegates.
+    Nothing is stored per row, every cell is generated on demand from the seed
+    of its row, so a model of millions of rows takes almost no memory,
+    and the same cell always has the same value.
+
+        auto model = SyntheticModel::create(1000000, "id,name,email,int,double,color,text");
+        tableView->setModel(model);
+*/
+class SyntheticModel : public QAbstractTableModel
+{
+public:
+    enum ColumnType { Id, Int, Double, Bool, Word, Words, Text, Name, Email, Color, Date };
+
+    struct Column
+    {
+        ColumnType type;
+        QString title;
+    };
+
+    SyntheticModel(int rows, const QVector<Column>& columns, quint64 seed = 0, QObject* parent = nullptr);
+
+    /// Makes a model with columns listed by comma separated names of types
+    /// (id, int, double, bool, word, words, text, name, email, color, date),
+    /// unknown names are treated as `word`. Columns are titled by their type names.
+    static SyntheticModel* create(int rows, const QString& columns, quint64 seed = 0, QObject* parent = nullptr);
+
+    static ColumnType columnType(const QString& name);
+
+    /// Returns the value of the cell. It's generated every time, so views
+    /// calling data() again and again for each cell are benchmarked honestly.
+    QVariant value(int row, int column) const;
+
+    const QVector<Column>& columns() const { return _columns; }
+    quint64 seed() const { return _seed; }
+    void setRowCount(int rows);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role = Qt::EditRole) override;
+
+private:
+    int _rows;
+    QVector<Column> _columns;
+    quint64 _seed;
+};
+
+} // namespace Testing
+} // namespace Ori
+
+#endif // ORI_SYNTHETIC_MODEL_H
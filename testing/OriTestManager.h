@@ -20,6 +20,11 @@ inline bool noGui()
     return QApplication::arguments().contains("nogui");
 }
 
+inline bool withBenchmarks()
+{
+    return QApplication::arguments().contains("benchmarks");
+}
+
 inline int runConsole(TestSuite tests)
 {
     TestLogger::enable(true);
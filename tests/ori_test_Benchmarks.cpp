@@ -0,0 +1,216 @@
+#include "../testing/OriTestBase.h"
+#include "../testing/OriTimeMeter.h"
+#include "../helpers/OriTheme.h"
+#include "../tools/OriPetname.h"
+#include "../tools/OriLoremIpsum.h"
+#include "../core/OriRandom.h"
+#include "../testing/OriSyntheticModel.h"
+#include "../helpers/OriTools.h"
+#include "../helpers/OriColorKernels.h"
+
+#include <QLabel>
+#include <QThread>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+
+namespace Ori {
+namespace Tests {
+namespace BenchmarkTests {
+
+TEST_METHOD(benchmark_colors_vs_stylesheet)
+{
+    QLabel label("Status");
+    label.resize(100, 20);
+    const int count = 200;
+
+    Testing::TimeMeter styleSheetMeter;
+    for (int i = 0; i < count; i++)
+    {
+        label.setStyleSheet(i % 2 ? QString() : QString("QLabel{background:red;color:white}"));
+        label.ensurePolished();
+        label.grab();
+    }
+    auto styleSheetTime = styleSheetMeter.stop();
+
+    Testing::TimeMeter paletteMeter;
+    for (int i = 0; i < count; i++)
+    {
+        if (i % 2)
+            Theme::resetColors(&label);
+        else
+            Theme::setColors(&label, Qt::white, Qt::red);
+        label.ensurePolished();
+        label.grab();
+    }
+    auto paletteTime = paletteMeter.stop();
+
+    TEST_LOG(QString("%1 switches of highlighting: stylesheet %2, palette %3")
+        .arg(count).arg(Testing::formatDuration(styleSheetTime), Testing::formatDuration(paletteTime)))
+}
+
+TEST_METHOD(benchmark_makeUnique)
+{
+    const int total = 1000000;
+    QVector<QString> names(total);
+
+    Testing::TimeMeter meter;
+    OriPetname::makeUnique(names.data(), total, 3);
+    auto duration = meter.stop();
+
+    TEST_LOG(QString("%1 names in %2, %3 names/s")
+        .arg(total).arg(Testing::formatDuration(duration)).arg(qint64(total * 1e9 / qMax<qint64>(duration, 1))))
+}
+
+TEST_METHOD(benchmark_streamText)
+{
+    LoremIpsum::StreamOptions options;
+    options.size = 256 * 1024 * 1024;
+
+    auto stats = LoremIpsum::streamText([](const QByteArray&){ return true; }, options);
+
+    TEST_LOG(QString("%1 MB, %2 words, %3 MB/s")
+        .arg(stats.bytes / 1048576).arg(stats.words).arg(stats.megabytesPerSecond(), 0, 'f', 1))
+}
+
+TEST_METHOD(benchmark_random_local)
+{
+    const int count = 10000000;
+    const int threads = qMax(QThread::idealThreadCount(), 1);
+    QVector<QThread*> workers;
+    for (int i = 0; i < threads; i++)
+        workers << QThread::create([]{
+            auto& rnd = Random::local();
+            quint64 sum = 0;
+            for (int k = 0; k < count; k++)
+                sum += rnd.bounded(255);
+            Q_UNUSED(sum)
+        });
+
+    Testing::TimeMeter meter;
+    for (auto w : workers) w->start();
+    for (auto w : workers) w->wait();
+    auto duration = meter.stop();
+    qDeleteAll(workers);
+
+    TEST_LOG(QString("%1 threads x %2 numbers in %3")
+        .arg(threads).arg(count).arg(Testing::formatDuration(duration)))
+}
+
+TEST_METHOD(benchmark_proxy_filter)
+{
+    const int rows = 1000000;
+    QScopedPointer<Testing::SyntheticModel> model(Testing::SyntheticModel::create(rows, "id,name,words,int"));
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(model.data());
+    proxy.setFilterKeyColumn(1);
+
+    Testing::TimeMeter meter;
+    proxy.setFilterFixedString("ox");
+    auto duration = meter.stop();
+
+    TEST_LOG(QString("%1 of %2 rows filtered in %3")
+        .arg(proxy.rowCount()).arg(rows).arg(Testing::formatDuration(duration)))
+}
+
+double minColorDistance(const QVector<QColor>& colors)
+{
+    double result = 1e10;
+    for (int i = 0; i < colors.size(); i++)
+        for (int j = i+1; j < colors.size(); j++)
+            result = qMin(result, Color::distance(Color::toOklab(colors.at(i)), Color::toOklab(colors.at(j))));
+    return result;
+}
+
+TEST_METHOD(benchmark_palette)
+{
+    Testing::TimeMeter meter;
+    auto colors = Color::palette(500);
+    auto duration = meter.stop();
+
+    TEST_LOG(QString("%1 colors in %2, min distance %3")
+        .arg(colors.size()).arg(Testing::formatDuration(duration)).arg(minColorDistance(colors), 0, 'f', 4))
+}
+
+QVector<QRgb> randomPixels(int count, quint64 seed)
+{
+    QVector<QRgb> pixels(count);
+    Random rnd(seed);
+    for (QRgb& p : pixels)
+        p = rnd.next32();
+    return pixels;
+}
+
+TEST_METHOD(benchmark_kernels)
+{
+    const int count = 4 * 1024 * 1024;
+    auto pixels = randomPixels(count, 6);
+    auto other = randomPixels(count, 7);
+    QVector<QRgb> result(count);
+    QVector<Color::Oklab> lab(count);
+    bool simd = Color::simdEnabled();
+
+    for (bool on : {false, true})
+    {
+        Color::setSimdEnabled(on);
+        Testing::TimeMeter blendMeter;
+        Color::blend(pixels.constData(), other.constData(), result.data(), count, 0.3);
+        auto blendTime = blendMeter.stop();
+        Testing::TimeMeter labMeter;
+        Color::toOklab(pixels.constData(), lab.data(), count);
+        auto labTime = labMeter.stop();
+        TEST_LOG(QString("%1: %2 pixels, blend %3, OKLab %4")
+            .arg(Color::simdEnabled() ? "SIMD" : "scalar").arg(count)
+            .arg(Testing::formatDuration(blendTime), Testing::formatDuration(labTime)))
+    }
+
+    Testing::TimeMeter meter;
+    for (int i = 0; i < count; i++)
+        result[i] = Color::blend(QColor(pixels.at(i)), QColor(other.at(i)), 0.3).rgba();
+    TEST_LOG(QString("QColor blend: %1").arg(Testing::formatDuration(meter.stop())))
+
+    Color::setSimdEnabled(simd);
+}
+
+TEST_METHOD(benchmark_format)
+{
+    const int count = 1000000;
+    auto colors = randomPixels(count, 10);
+
+    Testing::TimeMeter stringMeter;
+    QStringList strs;
+    strs.reserve(count);
+    for (QRgb c : colors)
+        strs << Color::formatRgb(QColor(c));
+    auto stringTime = stringMeter.stop();
+
+    QByteArray text(count * (Color::MaxFormattedLength + 1), 0);
+    Testing::TimeMeter bufferMeter;
+    int len = Color::format(colors.constData(), count, text.data(), Color::RgbText);
+    auto bufferTime = bufferMeter.stop();
+
+    QVector<QRgb> parsed(count);
+    Testing::TimeMeter parseMeter;
+    Color::parse(text.constData(), len, parsed.data(), count);
+    auto parseTime = parseMeter.stop();
+
+    TEST_LOG(QString("%1 colors: formatRgb %2, format into buffer %3, parse %4")
+        .arg(count).arg(Testing::formatDuration(stringTime), Testing::formatDuration(bufferTime),
+                        Testing::formatDuration(parseTime)))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Benchmarks",
+    ADD_TEST(benchmark_colors_vs_stylesheet),
+    ADD_TEST(benchmark_makeUnique),
+    ADD_TEST(benchmark_streamText),
+    ADD_TEST(benchmark_random_local),
+    ADD_TEST(benchmark_proxy_filter),
+    ADD_TEST(benchmark_palette),
+    ADD_TEST(benchmark_kernels),
+    ADD_TEST(benchmark_format),
+)
+
+} // namespace BenchmarkTests
+} // namespace Tests
+} // namespace Ori
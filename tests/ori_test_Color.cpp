@@ -0,0 +1,277 @@
+#include "../testing/OriTestBase.h"
+#include "../helpers/OriColorKernels.h"
+#include "../core/OriRandom.h"
+
+namespace Ori {
+namespace Tests {
+namespace ColorTests {
+
+double minDistance(const QVector<QColor>& colors)
+{
+    double result = 1e10;
+    for (int i = 0; i < colors.size(); i++)
+        for (int j = i+1; j < colors.size(); j++)
+            result = qMin(result, Color::distance(Color::toOklab(colors.at(i)), Color::toOklab(colors.at(j))));
+    return result;
+}
+
+TEST_METHOD(oklab_must_convert_back)
+{
+    QColor c(50, 150, 230);
+    Color::Oklab lab = Color::toOklab(c);
+    QColor c1 = Color::fromOklab(lab);
+
+    ASSERT_EQ_INT(c1.red(), c.red())
+    ASSERT_EQ_INT(c1.green(), c.green())
+    ASSERT_EQ_INT(c1.blue(), c.blue())
+    ASSERT_IS_TRUE(qAbs(Color::toOklab(Qt::white).L - 1) < 1e-6)
+}
+
+TEST_METHOD(palette_must_be_reproducible_by_seed)
+{
+    Color::PaletteOptions options;
+    options.seed = 11;
+
+    auto p1 = Color::palette(50, options);
+    auto p2 = Color::palette(50, options);
+    options.seed = 12;
+    auto p3 = Color::palette(50, options);
+
+    ASSERT_EQ_INT(p1.size(), 50)
+    ASSERT_IS_TRUE(p1 == p2)
+    ASSERT_IS_FALSE(p1 == p3)
+}
+
+TEST_METHOD(palette_must_be_better_spread_than_random)
+{
+    Color::PaletteOptions options;
+    auto colors = Color::palette(30, options);
+
+    QVector<QColor> randoms;
+    Random rnd(1);
+    for (int i = 0; i < 30; i++)
+        randoms << Color::random(rnd);
+
+    ASSERT_IS_TRUE(minDistance(colors) > minDistance(randoms))
+    for (const QColor& c : colors)
+    {
+        double L = Color::toOklab(c).L;
+        ASSERT_IS_TRUE(L > options.minLightness - 0.01 && L < options.maxLightness + 0.01)
+    }
+}
+
+TEST_METHOD(palette_must_avoid_colors)
+{
+    Color::PaletteOptions options;
+    options.minLightness = 0;
+    options.maxLightness = 1;
+    options.avoid << Qt::white;
+
+    auto colors = Color::palette(5, options);
+
+    for (const QColor& c : colors)
+    {
+        ASSERT_IS_TRUE(Color::distance(Color::toOklab(c), Color::toOklab(Qt::white)) > 0.2)
+    }
+}
+
+TEST_METHOD(random_must_be_reproducible_with_caller_state)
+{
+    QVector<QColor> colors1, colors2;
+    Random rnd1(5), rnd2(5);
+    QColor previous1, previous2;
+    for (int i = 0; i < 20; i++)
+    {
+        colors1 << Color::random(rnd1, 200, 50, 30, previous1);
+        colors2 << Color::random(rnd2, 200, 50, 30, previous2);
+    }
+
+    ASSERT_IS_TRUE(colors1 == colors2)
+    ASSERT_IS_TRUE(previous1 == colors1.last())
+    for (const QColor& c : colors1)
+    {
+        ASSERT_IS_TRUE(c.lightness() >= 50 && c.lightness() <= 200)
+    }
+}
+
+QVector<QRgb> randomPixels(int count, quint64 seed)
+{
+    QVector<QRgb> pixels(count);
+    Random rnd(seed);
+    for (QRgb& p : pixels)
+        p = rnd.next32();
+    return pixels;
+}
+
+bool channelsNear(QRgb c1, QRgb c2)
+{
+    return qAbs(qRed(c1) - qRed(c2)) <= 1 && qAbs(qGreen(c1) - qGreen(c2)) <= 1 &&
+           qAbs(qBlue(c1) - qBlue(c2)) <= 1 && qAbs(qAlpha(c1) - qAlpha(c2)) <= 1;
+}
+
+QRgb lerp(QRgb c1, QRgb c2, qreal r)
+{
+    return qRgba(qRound(qRed(c1) * (1-r) + qRed(c2) * r),
+                 qRound(qGreen(c1) * (1-r) + qGreen(c2) * r),
+                 qRound(qBlue(c1) * (1-r) + qBlue(c2) * r),
+                 qRound(qAlpha(c1) * (1-r) + qAlpha(c2) * r));
+}
+
+TEST_METHOD(blend_must_match_scalar_blend)
+{
+    auto pixels1 = randomPixels(1001, 1);
+    auto pixels2 = randomPixels(1001, 2);
+    Color::premultiply(pixels1.data(), pixels1.size());
+    Color::premultiply(pixels2.data(), pixels2.size());
+    QVector<QRgb> result(pixels1.size());
+
+    for (qreal r : {0.0, 0.3, 0.5, 1.0})
+    {
+        Color::blend(pixels1.constData(), pixels2.constData(), result.data(), result.size(), r);
+        for (int i = 0; i < result.size(); i++)
+        {
+            ASSERT_IS_TRUE(channelsNear(result.at(i), lerp(pixels1.at(i), pixels2.at(i), r)))
+            ASSERT_IS_TRUE(qRed(result.at(i)) <= qAlpha(result.at(i)))
+            ASSERT_IS_TRUE(qGreen(result.at(i)) <= qAlpha(result.at(i)))
+            ASSERT_IS_TRUE(qBlue(result.at(i)) <= qAlpha(result.at(i)))
+        }
+    }
+}
+
+TEST_METHOD(blend_must_not_take_color_of_transparent_pixels)
+{
+    // Transparent red blended half to half with opaque blue gives half-transparent blue, not purple
+    QImage image1(3, 2, QImage::Format_ARGB32);
+    QImage image2(3, 2, QImage::Format_ARGB32);
+    image1.fill(qRgba(255, 0, 0, 0));
+    image2.fill(qRgba(0, 0, 255, 255));
+
+    QImage result = Color::blend(image1, image2, 0.5);
+    ASSERT_IS_TRUE(result.format() == QImage::Format_ARGB32)
+    for (int y = 0; y < result.height(); y++)
+        for (int x = 0; x < result.width(); x++)
+        {
+            ASSERT_IS_TRUE(channelsNear(result.pixel(x, y), qRgba(0, 0, 255, 128)))
+        }
+
+    QImage premultiplied = Color::blend(image1.convertToFormat(QImage::Format_ARGB32_Premultiplied), image2, 0.5);
+    ASSERT_IS_TRUE(premultiplied.format() == QImage::Format_ARGB32_Premultiplied)
+    QRgb p = reinterpret_cast<const QRgb*>(premultiplied.constScanLine(0))[0];
+    ASSERT_IS_TRUE(channelsNear(p, qRgba(0, 0, 128, 128)))
+}
+
+TEST_METHOD(kernels_must_give_same_results_with_and_without_simd)
+{
+    auto pixels = randomPixels(1003, 3);
+    auto other = randomPixels(1003, 4);
+    bool simd = Color::simdEnabled();
+
+    QVector<QRgb> blended1(pixels.size()), blended2(pixels.size());
+    auto premultiplied1 = pixels, premultiplied2 = pixels;
+    QVector<Color::Oklab> lab1(pixels.size()), lab2(pixels.size());
+
+    Color::setSimdEnabled(true);
+    Color::blend(pixels.constData(), other.constData(), blended1.data(), pixels.size(), 0.7);
+    Color::premultiply(premultiplied1.data(), pixels.size());
+    Color::toOklab(pixels.constData(), lab1.data(), pixels.size());
+    Color::setSimdEnabled(false);
+    Color::blend(pixels.constData(), other.constData(), blended2.data(), pixels.size(), 0.7);
+    Color::premultiply(premultiplied2.data(), pixels.size());
+    Color::toOklab(pixels.constData(), lab2.data(), pixels.size());
+    Color::setSimdEnabled(simd);
+
+    ASSERT_IS_TRUE(blended1 == blended2)
+    ASSERT_IS_TRUE(premultiplied1 == premultiplied2)
+    for (int i = 0; i < pixels.size(); i++)
+    {
+        ASSERT_IS_TRUE(premultiplied1.at(i) == qPremultiply(pixels.at(i)))
+        ASSERT_IS_TRUE(Color::distance(lab1.at(i), lab2.at(i)) < 1e-4)
+        ASSERT_IS_TRUE(Color::distance(lab1.at(i), Color::toOklab(QColor(pixels.at(i)))) < 1e-4)
+    }
+}
+
+TEST_METHOD(hsl_must_convert_back)
+{
+    auto pixels = randomPixels(1000, 5);
+    QVector<Color::Hsl> hsl(pixels.size());
+    QVector<QRgb> result(pixels.size());
+
+    Color::toHsl(pixels.constData(), hsl.data(), pixels.size());
+    Color::fromHsl(hsl.constData(), result.data(), pixels.size());
+
+    for (int i = 0; i < pixels.size(); i++)
+    {
+        ASSERT_IS_TRUE(qRgb(qRed(pixels.at(i)), qGreen(pixels.at(i)), qBlue(pixels.at(i))) == result.at(i))
+    }
+}
+
+TEST_METHOD(format_must_write_the_same_as_string_functions)
+{
+    char buf[Color::MaxFormattedLength];
+    auto colors = randomPixels(100, 8);
+    colors << qRgb(0, 0, 0) << qRgb(128, 128, 128) << qRgb(255, 255, 255);
+    for (QRgb c : colors)
+    {
+        QColor color(c);
+        ASSERT_EQ_STR(QString::fromLatin1(buf, Color::formatHtml(c, buf)), color.name())
+        ASSERT_EQ_STR(QString::fromLatin1(buf, Color::formatRgb(c, buf)),
+            QString("rgb(%1, %2, %3)").arg(color.red()).arg(color.green()).arg(color.blue()))
+        ASSERT_EQ_STR(QString::fromLatin1(buf, Color::formatHsl(c, buf)),
+            QString("hsl(%1, %2, %3)").arg(color.hslHue()).arg(color.hslSaturation()).arg(color.lightness()))
+    }
+}
+
+TEST_METHOD(parse_must_read_formatted_colors)
+{
+    auto colors = randomPixels(300, 9);
+    for (QRgb& c : colors) c |= 0xFF000000;
+    QByteArray text(colors.size() * (Color::MaxFormattedLength + 1), 0);
+    QVector<QRgb> parsed(colors.size());
+
+    for (auto textFormat : {Color::HtmlText, Color::RgbText})
+    {
+        int len = Color::format(colors.constData(), colors.size(), text.data(), textFormat);
+        int consumed = 0;
+        int count = Color::parse(text.constData(), len, parsed.data(), parsed.size(), '\n', &consumed);
+
+        ASSERT_EQ_INT(count, colors.size())
+        ASSERT_EQ_INT(consumed, len)
+        ASSERT_IS_TRUE(parsed == colors)
+    }
+}
+
+TEST_METHOD(parse_must_stop_at_invalid_entry)
+{
+    QByteArray text("#ff0000\n\n  rgb( 0 , 255,0 )\nhsl(-1, 0, 128)\nrgb(256, 0, 0)\n#00f\n");
+    QRgb colors[10];
+    int consumed = 0;
+
+    int count = Color::parse(text.constData(), text.size(), colors, 10, '\n', &consumed);
+
+    ASSERT_EQ_INT(count, 3)
+    ASSERT_IS_TRUE(colors[0] == qRgb(255, 0, 0))
+    ASSERT_IS_TRUE(colors[1] == qRgb(0, 255, 0))
+    ASSERT_IS_TRUE(colors[2] == qRgb(128, 128, 128))
+    ASSERT_EQ_INT(consumed, text.indexOf("rgb(256"))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Color",
+    ADD_TEST(oklab_must_convert_back),
+    ADD_TEST(palette_must_be_reproducible_by_seed),
+    ADD_TEST(palette_must_be_better_spread_than_random),
+    ADD_TEST(palette_must_avoid_colors),
+    ADD_TEST(random_must_be_reproducible_with_caller_state),
+    ADD_TEST(blend_must_match_scalar_blend),
+    ADD_TEST(blend_must_not_take_color_of_transparent_pixels),
+    ADD_TEST(kernels_must_give_same_results_with_and_without_simd),
+    ADD_TEST(hsl_must_convert_back),
+    ADD_TEST(format_must_write_the_same_as_string_functions),
+    ADD_TEST(parse_must_read_formatted_colors),
+    ADD_TEST(parse_must_stop_at_invalid_entry),
+)
+
+} // namespace ColorTests
+} // namespace Tests
+} // namespace Ori
@@ -0,0 +1,93 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriFuzzyIndex.h"
+
+namespace Ori {
+namespace Tests {
+namespace FuzzyIndexTests {
+
+TEST_METHOD(score_must_reject_missing_chars)
+{
+    ASSERT_EQ_INT(FuzzyIndex::score("/home/user/data.txt", "dtz"), -1)
+    ASSERT_EQ_INT(FuzzyIndex::score("abc", "cba"), -1)
+}
+
+TEST_METHOD(score_must_prefer_word_starts_and_file_names)
+{
+    int inName = FuzzyIndex::score("/projects/demo/MainWindow.cpp", "mw");
+    int inPath = FuzzyIndex::score("/mywork/demo/about.cpp", "mw");
+
+    ASSERT_IS_TRUE(inName > inPath)
+}
+
+TEST_METHOD(match_must_order_by_score)
+{
+    // Ranks are opposite to scores, so the order can only come from scores
+    FuzzyIndex index;
+    index.insert("/projects/demo/mainwindow.cpp", 4);
+    index.insert("/projects/demo/main_window.cpp", 3);
+    index.insert("/projects/demo/MainWindow.cpp", 2);
+    index.insert("/projects/my_app/input/window.cpp", 1);
+    index.insert("/projects/demo/readme.md", 5);
+
+    auto items = index.match("mainw", 10);
+
+    ASSERT_EQ_INT(items.size(), 4)
+    ASSERT_EQ_STR(items.at(0), "/projects/demo/MainWindow.cpp")
+    ASSERT_EQ_STR(items.at(1), "/projects/demo/main_window.cpp")
+    ASSERT_EQ_STR(items.at(2), "/projects/demo/mainwindow.cpp")
+    ASSERT_EQ_STR(items.at(3), "/projects/my_app/input/window.cpp")
+}
+
+TEST_METHOD(score_must_take_best_placement_of_chars)
+{
+    // The first `m` is in `demo`, but matching from `MainWindow` gives more
+    int best = FuzzyIndex::score("/projects/demo/MainWindow.cpp", "mainw");
+    int other = FuzzyIndex::score("/projects/my_app/input/window.cpp", "mainw");
+
+    ASSERT_IS_TRUE(best > other)
+    ASSERT_IS_TRUE(FuzzyIndex::score("/a/ab/abc", "abc") > FuzzyIndex::score("/a/ab/axbxc", "abc"))
+}
+
+TEST_METHOD(match_must_order_equal_scores_by_rank)
+{
+    FuzzyIndex index;
+    index.insert("/a/file1.txt", 1);
+    index.insert("/a/file2.txt", 3);
+    index.insert("/a/file3.txt", 2);
+
+    auto items = index.match("file", 2);
+
+    ASSERT_EQ_INT(items.size(), 2)
+    ASSERT_EQ_STR(items.at(0), "/a/file2.txt")
+    ASSERT_EQ_STR(items.at(1), "/a/file3.txt")
+}
+
+TEST_METHOD(remove_must_keep_other_entries)
+{
+    FuzzyIndex index;
+    index.insert("one", 1);
+    index.insert("two", 2);
+    index.insert("three", 3);
+
+    index.remove("one");
+
+    ASSERT_EQ_INT(index.size(), 2)
+    ASSERT_IS_FALSE(index.contains("one"))
+    ASSERT_EQ_INT(index.match("three", 10).size(), 1)
+    ASSERT_EQ_INT(index.match("two", 10).size(), 1)
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("FuzzyIndex",
+    ADD_TEST(score_must_reject_missing_chars),
+    ADD_TEST(score_must_prefer_word_starts_and_file_names),
+    ADD_TEST(score_must_take_best_placement_of_chars),
+    ADD_TEST(match_must_order_by_score),
+    ADD_TEST(match_must_order_equal_scores_by_rank),
+    ADD_TEST(remove_must_keep_other_entries),
+)
+
+} // namespace FuzzyIndexTests
+} // namespace Tests
+} // namespace Ori
@@ -0,0 +1,89 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriLoremIpsum.h"
+#include "../core/OriRandom.h"
+
+namespace Ori {
+namespace Tests {
+namespace LoremIpsumTests {
+
+QByteArray streamToBuffer(const LoremIpsum::StreamOptions& options, LoremIpsum::StreamStats* stats = nullptr)
+{
+    QByteArray result;
+    auto s = LoremIpsum::streamText([&result](const QByteArray& chunk){
+        result.append(chunk);
+        return true;
+    }, options);
+    if (stats) *stats = s;
+    return result;
+}
+
+TEST_METHOD(streamText_must_generate_exact_size)
+{
+    LoremIpsum::StreamOptions options;
+    options.size = 100000;
+    options.chunkSize = 4096;
+
+    LoremIpsum::StreamStats stats;
+    auto text = streamToBuffer(options, &stats);
+
+    ASSERT_EQ_INT(text.size(), 100000)
+    ASSERT_EQ_INT(int(stats.bytes), 100000)
+    ASSERT_IS_TRUE(stats.words > 0)
+}
+
+TEST_METHOD(streamText_must_not_depend_on_thread_count)
+{
+    LoremIpsum::StreamOptions options;
+    options.size = 200000;
+    options.chunkSize = 4096;
+    options.seed = 5;
+
+    options.threads = 1;
+    auto text1 = streamToBuffer(options);
+    options.threads = 4;
+    auto text4 = streamToBuffer(options);
+    options.seed = 6;
+    auto text6 = streamToBuffer(options);
+
+    ASSERT_IS_TRUE(text1 == text4)
+    ASSERT_IS_FALSE(text1 == text6)
+}
+
+TEST_METHOD(streamText_must_stop_when_sink_refuses)
+{
+    LoremIpsum::StreamOptions options;
+    options.size = 1000000;
+    options.chunkSize = 4096;
+    int calls = 0;
+
+    auto stats = LoremIpsum::streamText([&calls](const QByteArray&){
+        return ++calls < 3;
+    }, options);
+
+    ASSERT_EQ_INT(calls, 3)
+    ASSERT_IS_TRUE(stats.bytes < options.size)
+}
+
+TEST_METHOD(makeEmail_must_be_reproducible_by_seed)
+{
+    Random rnd1(3), rnd2(3);
+
+    QString email1 = LoremIpsum::makeEmail(rnd1);
+    QString email2 = LoremIpsum::makeEmail(rnd2);
+
+    ASSERT_EQ_STR(email1, email2)
+    ASSERT_IS_TRUE(email1.contains('@'))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("LoremIpsum",
+    ADD_TEST(streamText_must_generate_exact_size),
+    ADD_TEST(streamText_must_not_depend_on_thread_count),
+    ADD_TEST(streamText_must_stop_when_sink_refuses),
+    ADD_TEST(makeEmail_must_be_reproducible_by_seed),
+)
+
+} // namespace LoremIpsumTests
+} // namespace Tests
+} // namespace Ori
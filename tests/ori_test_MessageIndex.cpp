@@ -0,0 +1,130 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriMessageIndex.h"
+
+namespace Ori {
+namespace Tests {
+namespace MessageIndexTests {
+
+using namespace Ori::Debug;
+
+void fillIndex(MessageIndex& index)
+{
+    index.append({QtDebugMsg, "Opening file data.txt", "main.cpp", "void MainWindow::openFile()", 10});
+    index.append({QtWarningMsg, "Unable to open file data.txt", "main.cpp", "void MainWindow::openFile()", 12});
+    index.append({QtDebugMsg, "Settings loaded", "settings.cpp", "void Settings::load()", 20});
+    index.append({QtWarningMsg, "Invalid settings value", "settings.cpp", "void Settings::load()", 25});
+    index.append({QtCriticalMsg, "Out of memory", QString(), QString(), 0});
+}
+
+TEST_METHOD(search_must_find_substring_case_insensitive)
+{
+    MessageIndex index;
+    fillIndex(index);
+
+    auto ids = index.search("FILE DATA");
+
+    ASSERT_EQ_INT(ids.size(), 2)
+    ASSERT_EQ_INT(ids.at(0), 0)
+    ASSERT_EQ_INT(ids.at(1), 1)
+}
+
+TEST_METHOD(search_must_verify_trigram_candidates)
+{
+    MessageIndex index;
+    index.append({QtDebugMsg, "abc bcd", QString(), QString(), 0});
+
+    // Both trigrams of the text are present in the message, but the text itself is not
+    auto ids = index.search("abcd");
+
+    ASSERT_IS_TRUE(ids.isEmpty())
+}
+
+TEST_METHOD(search_must_return_empty_when_trigram_absent)
+{
+    MessageIndex index;
+    fillIndex(index);
+
+    ASSERT_IS_TRUE(index.search("xyz").isEmpty())
+}
+
+TEST_METHOD(search_must_work_for_text_shorter_than_trigram)
+{
+    MessageIndex index;
+    fillIndex(index);
+
+    auto ids = index.search("of");
+
+    ASSERT_EQ_INT(ids.size(), 1)
+    ASSERT_EQ_INT(ids.at(0), 4)
+}
+
+TEST_METHOD(filter_must_combine_criteria)
+{
+    MessageIndex index;
+    fillIndex(index);
+    MessageQuery query;
+    query.types << QtWarningMsg;
+    query.function = "Settings::";
+
+    auto ids = index.filter(query);
+
+    ASSERT_EQ_INT(ids.size(), 1)
+    ASSERT_EQ_INT(ids.at(0), 3)
+}
+
+TEST_METHOD(filter_must_unite_types)
+{
+    MessageIndex index;
+    fillIndex(index);
+    MessageQuery query;
+    query.types << QtCriticalMsg << QtWarningMsg;
+
+    auto ids = index.filter(query);
+
+    ASSERT_EQ_INT(ids.size(), 3)
+    ASSERT_EQ_INT(ids.at(0), 1)
+    ASSERT_EQ_INT(ids.at(1), 3)
+    ASSERT_EQ_INT(ids.at(2), 4)
+}
+
+TEST_METHOD(filter_must_return_most_recent_when_limited)
+{
+    MessageIndex index;
+    fillIndex(index);
+    MessageQuery query;
+    query.file = "main.cpp";
+
+    auto ids = index.filter(query, 1);
+
+    ASSERT_EQ_INT(ids.size(), 1)
+    ASSERT_EQ_INT(ids.at(0), 1)
+}
+
+TEST_METHOD(clear_must_reset_index)
+{
+    MessageIndex index;
+    fillIndex(index);
+
+    index.clear();
+
+    ASSERT_EQ_INT(index.count(), 0)
+    ASSERT_IS_TRUE(index.search("file").isEmpty())
+    ASSERT_IS_TRUE(index.byType(QtDebugMsg).isEmpty())
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("MessageIndex",
+    ADD_TEST(search_must_find_substring_case_insensitive),
+    ADD_TEST(search_must_verify_trigram_candidates),
+    ADD_TEST(search_must_return_empty_when_trigram_absent),
+    ADD_TEST(search_must_work_for_text_shorter_than_trigram),
+    ADD_TEST(filter_must_combine_criteria),
+    ADD_TEST(filter_must_unite_types),
+    ADD_TEST(filter_must_return_most_recent_when_limited),
+    ADD_TEST(clear_must_reset_index),
+)
+
+} // namespace MessageIndexTests
+} // namespace Tests
+} // namespace Ori
@@ -0,0 +1,191 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriMruList.h"
+#include "../tools/OriSettings.h"
+
+#include <QAction>
+#include <QDir>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace Ori {
+namespace Tests {
+namespace MruListTests {
+
+class CaseInsensitiveMruList : public MruList
+{
+protected:
+    QString itemKey(const QString& item) const override { return item.toLower(); }
+};
+
+QStringList actionTexts(const MruList& mru)
+{
+    QStringList texts;
+    for (QAction* action : mru.actions())
+        texts << action->text();
+    return texts;
+}
+
+TEST_METHOD(append_must_find_same_items_by_key)
+{
+    CaseInsensitiveMruList mru;
+    mru.append("One");
+    mru.append("two");
+    mru.append("ONE");
+
+    ASSERT_EQ_INT(mru.count(), 2)
+    // The item keeps its original text, it's only moved to the top
+    ASSERT_IS_TRUE(mru.items() == QStringList({"One", "two"}))
+    ASSERT_IS_TRUE(actionTexts(mru) == mru.items())
+}
+
+TEST_METHOD(append_must_promote_and_trim_items)
+{
+    MruList mru;
+    mru.setMaxCount(3);
+    for (const char* item : {"1", "2", "3", "4"})
+        mru.append(item);
+    ASSERT_IS_TRUE(mru.items() == QStringList({"4", "3", "2"}))
+
+    mru.append("2");
+    ASSERT_IS_TRUE(mru.items() == QStringList({"2", "4", "3"}))
+
+    mru.append("5");
+    ASSERT_IS_TRUE(mru.items() == QStringList({"5", "2", "4"}))
+
+    mru.setMaxCount(2);
+    ASSERT_IS_TRUE(mru.items() == QStringList({"5", "2"}))
+    ASSERT_IS_TRUE(actionTexts(mru) == mru.items())
+    ASSERT_IS_TRUE(mru.match("4").isEmpty())
+}
+
+TEST_METHOD(menu_count_must_be_limited_by_default)
+{
+    MruList mru;
+    ASSERT_EQ_INT(mru.menuCount(), 10)
+    for (int i = 0; i < 15; i++)
+        mru.append(QString::number(i));
+    ASSERT_EQ_INT(mru.count(), 15)
+    ASSERT_EQ_INT(mru.actions().size(), 10)
+    ASSERT_EQ_STR(mru.actions().first()->text(), "14")
+}
+
+TEST_METHOD(actions_must_be_made_only_for_menu_items)
+{
+    MruList mru;
+    mru.setMenuCount(2);
+    for (const char* item : {"1", "2", "3", "4"})
+        mru.append(item);
+
+    ASSERT_EQ_INT(mru.count(), 4)
+    ASSERT_IS_TRUE(actionTexts(mru) == QStringList({"4", "3"}))
+
+    mru.append("1");
+    ASSERT_IS_TRUE(actionTexts(mru) == QStringList({"1", "4"}))
+
+    mru.setMenuCount(3);
+    ASSERT_IS_TRUE(actionTexts(mru) == QStringList({"1", "4", "3"}))
+}
+
+TEST_METHOD(file_list_must_normalize_paths)
+{
+    MruFileList mru;
+    QString path = QDir::current().absoluteFilePath("mru_test.txt");
+    mru.append(path);
+    mru.append("mru_test.txt");
+    mru.append("./subdir/../mru_test.txt");
+
+    ASSERT_EQ_INT(mru.count(), 1)
+
+    mru.append("other.txt");
+    ASSERT_EQ_INT(mru.count(), 2)
+}
+
+// Tests use the settings file of the test application, their keys are kept in a separate group
+void removeTestKeys()
+{
+    auto store = SettingsStore::instance();
+    store->flush();
+    QSettingsPtr s(Settings::open());
+    s->remove("Tests");
+    s->sync();
+    store->reload();
+}
+
+void loadTestList(MruList& mru)
+{
+    QSettingsPtr s(Settings::open());
+    s->beginGroup("Tests");
+    mru.load(s.get(), "mru");
+}
+
+class CountingMruList : public MruList
+{
+public:
+    int saves = 0;
+
+protected:
+    void save() override { saves++; MruList::save(); }
+};
+
+TEST_METHOD(bulk_changes_must_be_saved_at_once)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+
+    CountingMruList mru;
+    loadTestList(mru);
+    for (const char* item : {"1", "2", "3"})
+        mru.append(item);
+
+    // Changes are saved with a delay, so they are not in the settings yet
+    ASSERT_EQ_INT(mru.saves, 0)
+    ASSERT_IS_FALSE(store->contains("Tests/mru"))
+
+    QEventLoop loop;
+    QTimer::singleShot(1000, &loop, SLOT(quit()));
+    loop.exec();
+
+    ASSERT_EQ_INT(mru.saves, 1)
+    ASSERT_IS_TRUE(store->value("Tests/mru").toStringList() == QStringList({"3", "2", "1"}))
+
+    // Nothing is pending, so there is nothing to save
+    mru.flush();
+    ASSERT_EQ_INT(mru.saves, 1)
+    removeTestKeys();
+}
+
+TEST_METHOD(pending_changes_must_be_saved_on_flush_and_destruction)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+    {
+        CountingMruList mru;
+        loadTestList(mru);
+        mru.append("1");
+
+        // It's what is done when the application is about to quit
+        mru.flush();
+        ASSERT_EQ_INT(mru.saves, 1)
+        ASSERT_IS_TRUE(store->value("Tests/mru").toStringList() == QStringList({"1"}))
+
+        mru.append("2");
+    }
+    ASSERT_IS_TRUE(store->value("Tests/mru").toStringList() == QStringList({"2", "1"}))
+    removeTestKeys();
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("MruList",
+    ADD_TEST(append_must_find_same_items_by_key),
+    ADD_TEST(append_must_promote_and_trim_items),
+    ADD_TEST(menu_count_must_be_limited_by_default),
+    ADD_TEST(actions_must_be_made_only_for_menu_items),
+    ADD_TEST(file_list_must_normalize_paths),
+    ADD_TEST(bulk_changes_must_be_saved_at_once),
+    ADD_TEST(pending_changes_must_be_saved_on_flush_and_destruction),
+)
+
+} // namespace MruListTests
+} // namespace Tests
+} // namespace Ori
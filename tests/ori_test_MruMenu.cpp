@@ -0,0 +1,92 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriMruList.h"
+#include "../widgets/OriMruMenu.h"
+
+#include <QActionEvent>
+#include <QCoreApplication>
+
+namespace Ori {
+namespace Tests {
+namespace MruMenuTests {
+
+class ActionCounter : public QObject
+{
+public:
+    int added = 0;
+    int removed = 0;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (event->type() == QEvent::ActionAdded) added++;
+        else if (event->type() == QEvent::ActionRemoved) removed++;
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+QStringList itemTexts(const QMenu& menu)
+{
+    QStringList texts;
+    for (QAction* action : menu.actions())
+    {
+        if (action->isSeparator()) break;
+        texts << action->text();
+    }
+    return texts;
+}
+
+TEST_METHOD(menu_must_follow_items_order)
+{
+    MruList mru;
+    Widgets::MruMenu menu(&mru);
+    for (const char* item : {"1", "2", "3", "4"})
+        mru.append(item);
+    QCoreApplication::processEvents();
+    ASSERT_IS_TRUE(itemTexts(menu) == QStringList({"4", "3", "2", "1"}))
+    ASSERT_EQ_INT(menu.actions().size(), 7)
+
+    mru.append("2");
+    mru.append("5");
+    QCoreApplication::processEvents();
+    ASSERT_IS_TRUE(itemTexts(menu) == QStringList({"5", "2", "4", "3", "1"}))
+    ASSERT_EQ_INT(menu.actions().size(), 8)
+}
+
+TEST_METHOD(menu_must_not_reinsert_untouched_actions)
+{
+    MruList mru;
+    Widgets::MruMenu menu(&mru);
+    for (const char* item : {"1", "2", "3", "4", "5"})
+        mru.append(item);
+    QCoreApplication::processEvents();
+
+    ActionCounter counter;
+    menu.installEventFilter(&counter);
+
+    // Moving an item to top is a single insertion
+    mru.append("2");
+    QCoreApplication::processEvents();
+    ASSERT_IS_TRUE(itemTexts(menu) == QStringList({"2", "5", "4", "3", "1"}))
+    ASSERT_EQ_INT(counter.added, 1)
+    ASSERT_EQ_INT(counter.removed, 1)
+
+    // A new item is just added, others stay in place
+    counter.added = 0;
+    counter.removed = 0;
+    mru.append("6");
+    QCoreApplication::processEvents();
+    ASSERT_IS_TRUE(itemTexts(menu) == QStringList({"6", "2", "5", "4", "3", "1"}))
+    ASSERT_EQ_INT(counter.added, 1)
+    ASSERT_EQ_INT(counter.removed, 0)
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("MruMenu",
+    ADD_TEST(menu_must_follow_items_order),
+    ADD_TEST(menu_must_not_reinsert_untouched_actions),
+)
+
+} // namespace MruMenuTests
+} // namespace Tests
+} // namespace Ori
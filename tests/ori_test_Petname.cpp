@@ -0,0 +1,53 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriPetname.h"
+
+#include <QSet>
+
+namespace Ori {
+namespace Tests {
+namespace PetnameTests {
+
+TEST_METHOD(makeUnique_must_cover_whole_space_without_collisions)
+{
+    auto names = OriPetname::makeUnique(1000000, 2, '-', 42);
+
+    ASSERT_EQ_INT(names.size(), int(OriPetname::uniqueCount(2)))
+    QSet<QString> unique;
+    for (const QString& name : names)
+        unique.insert(name);
+    ASSERT_EQ_INT(unique.size(), names.size())
+}
+
+TEST_METHOD(makeUnique_must_be_reproducible_by_seed)
+{
+    auto names1 = OriPetname::makeUnique(100, 3, ' ', 1);
+    auto names2 = OriPetname::makeUnique(100, 3, ' ', 1);
+    auto names3 = OriPetname::makeUnique(100, 3, ' ', 2);
+
+    ASSERT_IS_TRUE(names1 == names2)
+    ASSERT_IS_FALSE(names1 == names3)
+    ASSERT_EQ_INT(names1.first().split(' ').size(), 3)
+}
+
+TEST_METHOD(makeUnique_must_continue_sequence)
+{
+    auto names = OriPetname::makeUnique(20, 4, ' ', 7);
+    QVector<QString> part(10);
+
+    int count = OriPetname::makeUnique(part.data(), part.size(), 4, ' ', 7, 10);
+
+    ASSERT_EQ_INT(count, 10)
+    ASSERT_IS_TRUE(part == names.mid(10))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Petname",
+    ADD_TEST(makeUnique_must_cover_whole_space_without_collisions),
+    ADD_TEST(makeUnique_must_be_reproducible_by_seed),
+    ADD_TEST(makeUnique_must_continue_sequence),
+)
+
+} // namespace PetnameTests
+} // namespace Tests
+} // namespace Ori
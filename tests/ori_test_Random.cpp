@@ -0,0 +1,63 @@
+#include "../testing/OriTestBase.h"
+#include "../core/OriRandom.h"
+
+namespace Ori {
+namespace Tests {
+namespace RandomTests {
+
+TEST_METHOD(random_must_be_reproducible_by_seed)
+{
+    Random r1(42), r2(42), r3(43), r4(42, 1);
+    bool differs3 = false, differs4 = false;
+    for (int i = 0; i < 100; i++)
+    {
+        quint64 v = r1.next();
+        ASSERT_IS_TRUE(v == r2.next())
+        if (v != r3.next()) differs3 = true;
+        if (v != r4.next()) differs4 = true;
+    }
+    ASSERT_IS_TRUE(differs3)
+    ASSERT_IS_TRUE(differs4)
+}
+
+TEST_METHOD(bounded_must_stay_in_range)
+{
+    Random rnd(1);
+    bool seen[10] = {};
+    for (int i = 0; i < 10000; i++)
+    {
+        quint32 v = rnd.bounded(10);
+        ASSERT_IS_TRUE(v < 10)
+        seen[v] = true;
+        int w = rnd.bounded(-5, 5);
+        ASSERT_IS_TRUE(w >= -5 && w <= 5)
+        double d = rnd.nextDouble();
+        ASSERT_IS_TRUE(d >= 0 && d < 1)
+    }
+    for (bool s : seen)
+    {
+        ASSERT_IS_TRUE(s)
+    }
+}
+
+TEST_METHOD(local_must_be_reseeded_by_global_seed)
+{
+    Random::setGlobalSeed(7);
+    quint64 v1 = Random::local().next();
+    Random::setGlobalSeed(7);
+    quint64 v2 = Random::local().next();
+
+    ASSERT_IS_TRUE(v1 == v2)
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Random",
+    ADD_TEST(random_must_be_reproducible_by_seed),
+    ADD_TEST(bounded_must_stay_in_range),
+    ADD_TEST(local_must_be_reseeded_by_global_seed),
+)
+
+} // namespace RandomTests
+} // namespace Tests
+} // namespace Ori
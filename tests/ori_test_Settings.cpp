@@ -0,0 +1,227 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriSettings.h"
+#include "../tools/OriSettingsSchema.h"
+
+#include <QEventLoop>
+#include <QTemporaryDir>
+#include <QTimer>
+
+namespace Ori {
+namespace Tests {
+namespace SettingsTests {
+
+// Tests use the settings file of the test application, their keys are kept in a separate group
+void removeTestKeys()
+{
+    auto store = SettingsStore::instance();
+    store->flush();
+    QSettingsPtr s(Settings::open());
+    s->remove("Tests");
+    s->sync();
+    store->reload();
+}
+
+QVariant fileValue(const QString& key)
+{
+    QSettingsPtr s(Settings::open());
+    return s->value(key);
+}
+
+TEST_METHOD(flush_must_write_pending_changes)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+
+    store->setValue("Tests/flushed", 42);
+
+    // Changes are kept in memory until the delayed flush or the application exit
+    ASSERT_EQ_INT(store->value("Tests/flushed").toInt(), 42)
+    ASSERT_IS_FALSE(fileValue("Tests/flushed").isValid())
+
+    // It's what is done when the application object is destroyed
+    store->flush();
+
+    ASSERT_EQ_INT(fileValue("Tests/flushed").toInt(), 42)
+    removeTestKeys();
+}
+
+void writeExternally(const QString& key, const QVariant& value)
+{
+    QSettingsPtr s(Settings::open());
+    s->setValue(key, value);
+    s->sync();
+}
+
+TEST_METHOD(reload_must_read_external_changes)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+    store->setValue("Tests/external", 1);
+    store->flush();
+
+    writeExternally("Tests/external", 2);
+    writeExternally("Tests/added", "new");
+
+    ASSERT_EQ_INT(store->value("Tests/external").toInt(), 1)
+    ASSERT_IS_FALSE(store->contains("Tests/added"))
+
+    store->reload();
+
+    ASSERT_EQ_INT(store->value("Tests/external").toInt(), 2)
+    ASSERT_EQ_STR(store->value("Tests/added").toString(), "new")
+    removeTestKeys();
+}
+
+TEST_METHOD(watcher_must_report_external_changes)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+    bool watching = store->watchEnabled();
+    store->setWatchEnabled(true);
+
+    QMap<QString, QVariant> changed;
+    QEventLoop loop;
+    auto connection = QObject::connect(store, &SettingsStore::valueChanged,
+        [&](const QString& key, const QVariant& value){ changed[key] = value; loop.quit(); });
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+
+    writeExternally("Tests/watched", 3);
+    loop.exec();
+
+    QObject::disconnect(connection);
+    store->setWatchEnabled(watching);
+
+    ASSERT_IS_TRUE(changed.contains("Tests/watched"))
+    ASSERT_EQ_INT(changed["Tests/watched"].toInt(), 3)
+    ASSERT_EQ_INT(store->value("Tests/watched").toInt(), 3)
+    removeTestKeys();
+}
+
+struct TestSettings
+{
+    ORI_SETTING(int, count, "Tests/count", 10)
+    ORI_SETTING(QString, name, "Tests/name", "default")
+};
+
+TEST_METHOD(key_must_return_default_when_absent)
+{
+    removeTestKeys();
+
+    ASSERT_EQ_INT(TestSettings::count().value(), 10)
+    ASSERT_EQ_STR(TestSettings::name().value(), "default")
+}
+
+TEST_METHOD(key_must_share_value_with_store)
+{
+    removeTestKeys();
+    auto store = SettingsStore::instance();
+
+    TestSettings::count().setValue(20);
+    ASSERT_EQ_INT(store->value("Tests/count").toInt(), 20)
+
+    // Cached slot value is updated when the key is written by path
+    store->setValue("Tests/count", 30);
+    ASSERT_EQ_INT(TestSettings::count().value(), 30)
+
+    TestSettings::name().setValue("changed");
+    store->flush();
+    ASSERT_EQ_STR(fileValue("Tests/name").toString(), "changed")
+    removeTestKeys();
+}
+
+TEST_METHOD(key_must_see_reloaded_value)
+{
+    removeTestKeys();
+    ASSERT_EQ_INT(TestSettings::count().value(), 10)
+
+    writeExternally("Tests/count", 40);
+    SettingsStore::instance()->reload();
+
+    ASSERT_EQ_INT(TestSettings::count().value(), 40)
+    removeTestKeys();
+    ASSERT_EQ_INT(TestSettings::count().value(), 10)
+}
+
+TEST_METHOD(key_must_return_default_when_not_convertible)
+{
+    removeTestKeys();
+
+    writeExternally("Tests/count", "abc");
+    SettingsStore::instance()->reload();
+
+    ASSERT_EQ_INT(TestSettings::count().value(), 10)
+
+    writeExternally("Tests/count", "50");
+    SettingsStore::instance()->reload();
+
+    ASSERT_EQ_INT(TestSettings::count().value(), 50)
+    removeTestKeys();
+}
+
+void writeFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write(data);
+}
+
+TEST_METHOD(snapshot_must_read_what_was_written)
+{
+    QTemporaryDir dir;
+    QString snapshotPath = dir.path() + "/settings.snapshot";
+    SettingsSnapshot snapshot;
+    snapshot.iniFile = dir.path() + "/settings.ini";
+    snapshot.values["View/showToolbar"] = true;
+    snapshot.values["Common/recentCount"] = 10;
+    snapshot.absent << "View/missing";
+
+    // There is nothing to bind the snapshot to
+    ASSERT_IS_FALSE(snapshot.write(snapshotPath))
+
+    writeFile(snapshot.iniFile, "[View]\nshowToolbar=true\n");
+    ASSERT_IS_TRUE(snapshot.write(snapshotPath))
+
+    SettingsSnapshot loaded;
+    ASSERT_IS_TRUE(loaded.read(snapshotPath))
+    ASSERT_EQ_STR(loaded.iniFile, snapshot.iniFile)
+    ASSERT_IS_TRUE(loaded.values == snapshot.values)
+    ASSERT_IS_TRUE(loaded.absent == snapshot.absent)
+}
+
+TEST_METHOD(snapshot_must_be_stale_after_ini_file_changed)
+{
+    QTemporaryDir dir;
+    QString snapshotPath = dir.path() + "/settings.snapshot";
+    SettingsSnapshot snapshot;
+    snapshot.iniFile = dir.path() + "/settings.ini";
+    snapshot.values["View/showToolbar"] = true;
+    writeFile(snapshot.iniFile, "[View]\nshowToolbar=true\n");
+    ASSERT_IS_TRUE(snapshot.write(snapshotPath))
+
+    writeFile(snapshot.iniFile, "[View]\nshowToolbar=false\n");
+
+    SettingsSnapshot loaded;
+    ASSERT_IS_FALSE(loaded.read(snapshotPath))
+
+    QFile::remove(snapshot.iniFile);
+    ASSERT_IS_FALSE(loaded.read(snapshotPath))
+    ASSERT_IS_FALSE(loaded.read(dir.path() + "/nothing.snapshot"))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Settings",
+    ADD_TEST(flush_must_write_pending_changes),
+    ADD_TEST(reload_must_read_external_changes),
+    ADD_TEST(watcher_must_report_external_changes),
+    ADD_TEST(key_must_return_default_when_absent),
+    ADD_TEST(key_must_share_value_with_store),
+    ADD_TEST(key_must_see_reloaded_value),
+    ADD_TEST(key_must_return_default_when_not_convertible),
+    ADD_TEST(snapshot_must_read_what_was_written),
+    ADD_TEST(snapshot_must_be_stale_after_ini_file_changed),
+)
+
+} // namespace SettingsTests
+} // namespace Tests
+} // namespace Ori
@@ -0,0 +1,57 @@
+#include "../testing/OriTestBase.h"
+#include "../widgets/OriStatusBar.h"
+
+#include <QApplication>
+#include <QLabel>
+
+namespace Ori {
+namespace Tests {
+namespace StatusBarTests {
+
+QColor sectionBackground(Widgets::StatusBar& statusBar, int index)
+{
+    QLabel* label = statusBar.findChildren<QLabel*>().at(index);
+    QImage image = label->grab().toImage();
+    return image.pixelColor(image.width() / 2, image.height() / 2);
+}
+
+void checkHighlighting(Ori::Testing::TestBase* test, Widgets::StatusBar& statusBar)
+{
+    statusBar.resize(300, 30);
+    statusBar.show();
+    QColor normal = sectionBackground(statusBar, 0);
+
+    statusBar.highlightError(0);
+    ASSERT_IS_TRUE(sectionBackground(statusBar, 0) == QColor(Qt::red))
+
+    statusBar.highlightReset(0);
+    ASSERT_IS_TRUE(sectionBackground(statusBar, 0) == normal)
+}
+
+TEST_METHOD(highlight_must_be_visible_without_app_stylesheet)
+{
+    Widgets::StatusBar statusBar(2);
+    checkHighlighting(test, statusBar);
+}
+
+TEST_METHOD(highlight_must_be_visible_with_app_stylesheet)
+{
+    QString oldStyleSheet = qApp->styleSheet();
+    qApp->setStyleSheet("QLabel { background: white; color: black; }");
+
+    Widgets::StatusBar statusBar(2);
+    checkHighlighting(test, statusBar);
+
+    qApp->setStyleSheet(oldStyleSheet);
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("StatusBar",
+    ADD_TEST(highlight_must_be_visible_without_app_stylesheet),
+    ADD_TEST(highlight_must_be_visible_with_app_stylesheet),
+)
+
+} // namespace StatusBarTests
+} // namespace Tests
+} // namespace Ori
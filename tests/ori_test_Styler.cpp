@@ -0,0 +1,85 @@
+#include "../testing/OriTestBase.h"
+#include "../tools/OriStyler.h"
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QLabel>
+#include <QStyle>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace Ori {
+namespace Tests {
+namespace StylerTests {
+
+bool isStyle(QStyle* s, const QString& style)
+{
+    return s->objectName().compare(style, Qt::CaseInsensitive) == 0;
+}
+
+bool hasStyle(QWidget* w, const QString& style)
+{
+    return isStyle(w->style(), style);
+}
+
+bool waitSwitched(Styler& styler)
+{
+    QEventLoop loop;
+    bool switched = false;
+    QObject::connect(&styler, &Styler::styleSwitched, [&]{ switched = true; loop.quit(); });
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+    loop.exec();
+    return switched;
+}
+
+TEST_METHOD(staged_switch_must_end_with_application_style)
+{
+    QString oldStyle = qApp->style()->objectName();
+    QString newStyle = oldStyle.compare("fusion", Qt::CaseInsensitive) == 0 ? "Windows" : "Fusion";
+
+    QWidget window;
+    auto layout = new QVBoxLayout(&window);
+    auto visibleLabel = new QLabel("Visible");
+    auto hiddenLabel = new QLabel("Hidden");
+    layout->addWidget(visibleLabel);
+    layout->addWidget(hiddenLabel);
+    hiddenLabel->hide();
+    window.show();
+
+    Styler styler;
+    bool switched = false;
+    QObject::connect(&styler, &Styler::styleSwitched, [&]{ switched = true; });
+    styler.setCurrentStyle(newStyle, Styler::Staged);
+    // Visible widgets are styled at once
+    ASSERT_IS_TRUE(hasStyle(visibleLabel, newStyle))
+
+    QLabel newLabel("New");
+    ASSERT_IS_TRUE(hasStyle(&newLabel, newStyle))
+
+    if (!switched)
+    {
+        ASSERT_IS_TRUE(waitSwitched(styler))
+    }
+    ASSERT_IS_TRUE(hasStyle(hiddenLabel, newStyle))
+    ASSERT_IS_TRUE(isStyle(qApp->style(), newStyle))
+
+    // Widgets created after the switch get the style from the application
+    QLabel laterLabel("Later");
+    ASSERT_IS_FALSE(laterLabel.testAttribute(Qt::WA_SetStyle))
+    ASSERT_IS_TRUE(hasStyle(&laterLabel, newStyle))
+
+    styler.setCurrentStyle(oldStyle, Styler::Immediate);
+    ASSERT_IS_TRUE(hasStyle(visibleLabel, oldStyle))
+    ASSERT_IS_FALSE(visibleLabel->testAttribute(Qt::WA_SetStyle))
+    ASSERT_IS_TRUE(hasStyle(&newLabel, oldStyle))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Styler",
+    ADD_TEST(staged_switch_must_end_with_application_style),
+)
+
+} // namespace StylerTests
+} // namespace Tests
+} // namespace Ori
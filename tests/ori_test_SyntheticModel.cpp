@@ -0,0 +1,57 @@
+#include "../testing/OriTestBase.h"
+#include "../testing/OriSyntheticModel.h"
+
+namespace Ori {
+namespace Tests {
+namespace SyntheticModelTests {
+
+using Testing::SyntheticModel;
+
+TEST_METHOD(create_must_parse_columns)
+{
+    QScopedPointer<SyntheticModel> model(SyntheticModel::create(10, "id, name,color,,unknown"));
+
+    ASSERT_EQ_INT(model->columnCount(), 4)
+    ASSERT_EQ_INT(model->rowCount(), 10)
+    ASSERT_IS_TRUE(model->columns().at(0).type == SyntheticModel::Id)
+    ASSERT_IS_TRUE(model->columns().at(1).type == SyntheticModel::Name)
+    ASSERT_IS_TRUE(model->columns().at(2).type == SyntheticModel::Color)
+    ASSERT_IS_TRUE(model->columns().at(3).type == SyntheticModel::Word)
+    ASSERT_EQ_STR(model->headerData(1, Qt::Horizontal).toString(), "name")
+}
+
+TEST_METHOD(value_must_depend_only_on_seed_and_cell)
+{
+    QScopedPointer<SyntheticModel> model1(SyntheticModel::create(10000000, "int,text,email", 3));
+    QScopedPointer<SyntheticModel> model2(SyntheticModel::create(100, "int,text", 3));
+    QScopedPointer<SyntheticModel> model3(SyntheticModel::create(100, "int,text", 4));
+
+    ASSERT_IS_TRUE(model1->value(50, 0) == model2->value(50, 0))
+    ASSERT_IS_TRUE(model1->value(50, 1) == model2->value(50, 1))
+    ASSERT_IS_TRUE(model1->value(50, 1) == model1->value(50, 1))
+    ASSERT_IS_FALSE(model1->value(50, 1) == model3->value(50, 1))
+    ASSERT_IS_FALSE(model1->value(9999999, 2).toString().isEmpty())
+    ASSERT_IS_FALSE(model1->value(10000000, 2).isValid())
+}
+
+TEST_METHOD(models_with_different_seeds_must_not_share_rows)
+{
+    QScopedPointer<SyntheticModel> model1(SyntheticModel::create(100, "text", 2));
+    QScopedPointer<SyntheticModel> model2(SyntheticModel::create(100, "text", 3));
+
+    // Rows would coincide if the seed were just xored with the row index
+    for (int row = 0; row < 4; row++)
+        ASSERT_IS_FALSE(model1->value(row ^ 1, 0) == model2->value(row, 0))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("SyntheticModel",
+    ADD_TEST(create_must_parse_columns),
+    ADD_TEST(value_must_depend_only_on_seed_and_cell),
+    ADD_TEST(models_with_different_seeds_must_not_share_rows),
+)
+
+} // namespace SyntheticModelTests
+} // namespace Tests
+} // namespace Ori
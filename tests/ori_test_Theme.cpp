@@ -0,0 +1,151 @@
+#include "../testing/OriTestBase.h"
+#include "../helpers/OriTheme.h"
+
+#include <QLabel>
+
+namespace Ori {
+namespace Tests {
+namespace ThemeTests {
+
+TEST_METHOD(makeStyleSheet_must_substitute_vars)
+{
+    QString raw =
+        "$main: red;\n"
+        "$main-border: 1px solid $main;\n"
+        "QLabel { color: $main; border: $main-border; }\n";
+
+    auto styleSheet = Theme::makeStyleSheet(raw);
+
+    ASSERT_EQ_STR(styleSheet, "\n\nQLabel { color: red; border: 1px solid red; }\n")
+}
+
+TEST_METHOD(makeStyleSheet_must_keep_unknown_vars)
+{
+    auto styleSheet = Theme::makeStyleSheet("QLabel { color: $unknown; }");
+
+    ASSERT_EQ_STR(styleSheet, "QLabel { color: $unknown; }")
+}
+
+TEST_METHOD(makeStyleSheet_must_process_platform_lines)
+{
+    QString raw =
+        "QLabel {\n"
+        "  windows: color: red;\n"
+        "  linux: color: green;\n"
+        "  macos: color: blue;\n"
+        "}";
+
+    auto styleSheet = Theme::makeStyleSheet(raw);
+
+#if defined(Q_OS_WIN)
+    ASSERT_EQ_STR(styleSheet, "QLabel {\n color: red;\n\n\n}")
+#elif defined(Q_OS_LINUX)
+    ASSERT_EQ_STR(styleSheet, "QLabel {\n\n color: green;\n\n}")
+#elif defined(Q_OS_MAC)
+    ASSERT_EQ_STR(styleSheet, "QLabel {\n\n\n color: blue;\n}")
+#endif
+}
+
+TEST_METHOD(styleSheetVars_must_resolve_references)
+{
+    auto vars = Theme::styleSheetVars("$red: #ff0000;\n$palette-window: $red;\nQLabel { color: $red; }");
+
+    ASSERT_EQ_INT(vars.size(), 2)
+    ASSERT_EQ_STR(vars["$palette-window"], "#ff0000")
+}
+
+TEST_METHOD(makePalette_must_take_colors_from_vars)
+{
+    QMap<QString, QString> vars;
+    vars["$palette-window"] = "rgb(10, 20, 30)";
+    vars["$palette-disabled-text"] = "rgba(1, 2, 3, 4)";
+    vars["$palette-base"] = "not a color";
+    QPalette base;
+    base.setColor(QPalette::Base, Qt::green);
+
+    auto palette = Theme::makePalette(vars, base);
+
+    ASSERT_IS_TRUE(palette.color(QPalette::Active, QPalette::Window) == QColor(10, 20, 30))
+    ASSERT_IS_TRUE(palette.color(QPalette::Disabled, QPalette::Text) == QColor(1, 2, 3, 4))
+    ASSERT_IS_TRUE(palette.color(QPalette::Base) == QColor(Qt::green))
+}
+
+TEST_METHOD(parseRules_must_split_rules_by_selectors)
+{
+    auto rules = Theme::StyleSheetReloader::parseRules(
+        "/* header { color: red; } */\n"
+        "QLabel, QToolButton#run { color: blue; }\n"
+        "QLabel { /* inline */ border: none; }\n"
+        "QToolBar > QToolButton:hover\n{\n  background: white;\n}");
+
+    ASSERT_EQ_INT(rules.size(), 3)
+    ASSERT_IS_FALSE(rules.contains("header"))
+    ASSERT_EQ_STR(rules["QLabel"], "color: blue; border: none;")
+    ASSERT_EQ_STR(rules["QToolButton#run"], "color: blue;")
+    ASSERT_EQ_STR(rules["QToolBar > QToolButton:hover"], "background: white;")
+}
+
+TEST_METHOD(parseRules_must_ignore_unclosed_comment_and_rule)
+{
+    auto rules = Theme::StyleSheetReloader::parseRules("QLabel { color: red; } QWidget { color: /* blue; }");
+
+    ASSERT_EQ_INT(rules.size(), 1)
+    ASSERT_EQ_STR(rules["QLabel"], "color: red;")
+}
+
+TEST_METHOD(selectorTarget_must_take_last_compound_selector)
+{
+    auto target = Theme::StyleSheetReloader::selectorTarget("QToolBar > QToolButton#run:hover");
+    ASSERT_EQ_STR(target.className, "QToolButton")
+    ASSERT_EQ_STR(target.objectName, "run")
+    ASSERT_IS_FALSE(target.exactClass)
+
+    target = Theme::StyleSheetReloader::selectorTarget("QDialog .QLabel");
+    ASSERT_EQ_STR(target.className, "QLabel")
+    ASSERT_IS_TRUE(target.exactClass)
+
+    target = Theme::StyleSheetReloader::selectorTarget("#status_bar");
+    ASSERT_IS_TRUE(target.className.isEmpty())
+    ASSERT_EQ_STR(target.objectName, "status_bar")
+
+    target = Theme::StyleSheetReloader::selectorTarget("Ori--Widgets--MruMenu");
+    ASSERT_EQ_STR(target.className, "Ori::Widgets::MruMenu")
+
+    ASSERT_IS_FALSE(Theme::StyleSheetReloader::selectorTarget("*").isValid())
+    ASSERT_IS_FALSE(Theme::StyleSheetReloader::selectorTarget(":disabled").isValid())
+}
+
+TEST_METHOD(selectorTarget_must_match_widgets)
+{
+    QLabel label;
+    label.setObjectName("status");
+    QWidget widget;
+
+    auto target = [](const char* selector){ return Theme::StyleSheetReloader::selectorTarget(selector); };
+    ASSERT_IS_TRUE(target("QLabel").matches(&label))
+    ASSERT_IS_TRUE(target("QWidget").matches(&label))
+    ASSERT_IS_FALSE(target(".QWidget").matches(&label))
+    ASSERT_IS_TRUE(target(".QWidget").matches(&widget))
+    ASSERT_IS_TRUE(target("QLabel#status").matches(&label))
+    ASSERT_IS_FALSE(target("QLabel#other").matches(&label))
+    ASSERT_IS_TRUE(target("#status").matches(&label))
+    ASSERT_IS_FALSE(target("#status").matches(&widget))
+}
+
+//------------------------------------------------------------------------------
+
+TEST_GROUP("Theme",
+    ADD_TEST(makeStyleSheet_must_substitute_vars),
+    ADD_TEST(makeStyleSheet_must_keep_unknown_vars),
+    ADD_TEST(makeStyleSheet_must_process_platform_lines),
+    ADD_TEST(styleSheetVars_must_resolve_references),
+    ADD_TEST(makePalette_must_take_colors_from_vars),
+    ADD_TEST(parseRules_must_split_rules_by_selectors),
+    ADD_TEST(parseRules_must_ignore_unclosed_comment_and_rule),
+    ADD_TEST(selectorTarget_must_take_last_compound_selector),
+    ADD_TEST(selectorTarget_must_match_widgets),
+)
+
+} // namespace ThemeTests
+} // namespace Tests
+} // namespace Ori
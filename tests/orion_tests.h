@@ -10,12 +10,42 @@ USE_GROUP(MathTests)        // ori_test_math.cpp
 USE_GROUP(TemplatesTests)   // ori_test_Templates.cpp
 USE_GROUP(VersionTests)     // ori_test_Version.cpp
 USE_GROUP(FilterTests)      // ori_test_Filter.cpp
+USE_GROUP(MessageIndexTests) // ori_test_MessageIndex.cpp
+USE_GROUP(FuzzyIndexTests)  // ori_test_FuzzyIndex.cpp
+USE_GROUP(MruListTests)     // ori_test_MruList.cpp
+USE_GROUP(MruMenuTests)     // ori_test_MruMenu.cpp
+USE_GROUP(ThemeTests)       // ori_test_Theme.cpp
+USE_GROUP(PetnameTests)     // ori_test_Petname.cpp
+USE_GROUP(LoremIpsumTests)  // ori_test_LoremIpsum.cpp
+USE_GROUP(RandomTests)      // ori_test_Random.cpp
+USE_GROUP(SyntheticModelTests) // ori_test_SyntheticModel.cpp
+USE_GROUP(ColorTests)       // ori_test_Color.cpp
+USE_GROUP(StylerTests)      // ori_test_Styler.cpp
+USE_GROUP(SettingsTests)    // ori_test_Settings.cpp
+USE_GROUP(StatusBarTests)   // ori_test_StatusBar.cpp
+
+// Benchmarks take a while and their results are only informative,
+// so they are not in the suite and only run on demand
+USE_GROUP(BenchmarkTests)   // ori_test_Benchmarks.cpp
 
 TEST_SUITE(
     ADD_GROUP(MathTests),
     ADD_GROUP(TemplatesTests),
     ADD_GROUP(VersionTests),
     ADD_GROUP(FilterTests),
+    ADD_GROUP(MessageIndexTests),
+    ADD_GROUP(FuzzyIndexTests),
+    ADD_GROUP(MruListTests),
+    ADD_GROUP(MruMenuTests),
+    ADD_GROUP(ThemeTests),
+    ADD_GROUP(PetnameTests),
+    ADD_GROUP(LoremIpsumTests),
+    ADD_GROUP(RandomTests),
+    ADD_GROUP(SyntheticModelTests),
+    ADD_GROUP(ColorTests),
+    ADD_GROUP(StylerTests),
+    ADD_GROUP(SettingsTests),
+    ADD_GROUP(StatusBarTests),
 )
 
 namespace All {
@@ -24,6 +54,19 @@ namespace All {
         ADD_GROUP(TemplatesTests),
         ADD_GROUP(VersionTests),
         ADD_GROUP(FilterTests),
+        ADD_GROUP(MessageIndexTests),
+        ADD_GROUP(FuzzyIndexTests),
+        ADD_GROUP(MruListTests),
+        ADD_GROUP(MruMenuTests),
+        ADD_GROUP(ThemeTests),
+        ADD_GROUP(PetnameTests),
+        ADD_GROUP(LoremIpsumTests),
+        ADD_GROUP(RandomTests),
+        ADD_GROUP(SyntheticModelTests),
+        ADD_GROUP(ColorTests),
+        ADD_GROUP(StylerTests),
+        ADD_GROUP(SettingsTests),
+        ADD_GROUP(StatusBarTests),
     )
 }
 
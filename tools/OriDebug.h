@@ -1,8 +1,13 @@
 #ifndef ORI_DEBUG_H
 #define ORI_DEBUG_H
 
-#include <QTextEdit>
+#include "OriMessageIndex.h"
+
+#include <QBoxLayout>
+#include <QComboBox>
+#include <QLineEdit>
 #include <QPointer>
+#include <QTextEdit>
 
 namespace Ori {
 namespace Debug {
@@ -19,26 +24,132 @@ QString messageType(QtMsgType type)
     }
 }
 
+QString sanitizeHtml(const QString& msg)
+{
+    return QString(msg).replace("<", "&lt;").replace(">", "&gt;").replace("\n", "<br>");
+}
+
+// Maximal number of messages shown in the console when a filter is applied.
+// The index holds the whole history, only rendering is limited.
+const int maxShownMessages = 5000;
+
+struct Console
+{
+    QPointer<QWidget> window;
+    QTextEdit* view = nullptr;
+    QComboBox* types = nullptr;
+    QLineEdit* search = nullptr;
+    MessageIndex index;
+    MessageQuery query;
+};
+
+Console& console()
+{
+    static Console console;
+    return console;
+}
+
+QString formatMessage(const Message& msg)
+{
+    QString s = QString("<p><b>%1</b>: %2").arg(messageType(msg.type), sanitizeHtml(msg.text));
+
+    // Messages inside of Qt-code has no context filled
+    // but function info already built into the message text
+    if (!msg.file.isEmpty())
+        s += QString("<br><font color=gray>(%1:%2, %3</font>")
+            .arg(msg.file).arg(msg.line).arg(msg.function);
+    return s;
+}
+
+/// Makes a query from the search string.
+/// Words `file:<name>` and `func:<name>` restrict messages by their origin,
+/// the rest of the string is searched in message texts.
+MessageQuery parseQuery(const QString& search, int type)
+{
+    MessageQuery query;
+    if (type >= 0)
+        query.types << QtMsgType(type);
+    QStringList words;
+    for (const QString& word : search.split(' ', QString::SkipEmptyParts))
+    {
+        if (word.startsWith("file:"))
+            query.file = word.mid(5);
+        else if (word.startsWith("func:"))
+            query.function = word.mid(5);
+        else
+            words << word;
+    }
+    query.text = words.join(' ');
+    return query;
+}
+
+void applyFilter()
+{
+    Console& c = console();
+    c.query = parseQuery(c.search->text(), c.types->currentData().toInt());
+    QStringList msgs;
+    for (int id : c.index.filter(c.query, maxShownMessages))
+        msgs << formatMessage(c.index.message(id));
+    c.view->setHtml(msgs.join(QString()));
+}
+
 QTextEdit* consoleWindow()
 {
-    static QPointer<QTextEdit> console;
-    if (!console)
+    Console& c = console();
+    if (!c.window)
     {
-        console = new QTextEdit;
+        c.window = new QWidget;
+        c.window->setWindowTitle("Debug Console");
+
+        c.view = new QTextEdit;
+        c.view->setReadOnly(true);
     #ifdef Q_OS_WIN
-        console->setFont(QFont("Courier", 9));
+        c.view->setFont(QFont("Courier", 9));
     #else
-        console->setFont(QFont("Monospace", 10));
+        c.view->setFont(QFont("Monospace", 10));
     #endif
-        console->setGeometry(10, 30, 800, 300);
+
+        c.types = new QComboBox;
+        c.types->addItem("All", -1);
+        for (auto type : {QtDebugMsg, QtWarningMsg, QtCriticalMsg, QtFatalMsg})
+            c.types->addItem(messageType(type), int(type));
+        QObject::connect(c.types, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), applyFilter);
+
+        c.search = new QLineEdit;
+        c.search->setPlaceholderText("Search text, file:<name>, func:<name>");
+        QObject::connect(c.search, &QLineEdit::textChanged, applyFilter);
+
+        auto toolbar = new QHBoxLayout;
+        toolbar->addWidget(c.types);
+        toolbar->addWidget(c.search, 1);
+
+        auto layout = new QVBoxLayout(c.window);
+        layout->setContentsMargins(3, 3, 3, 3);
+        layout->addLayout(toolbar);
+        layout->addWidget(c.view);
+
+        c.window->setGeometry(10, 30, 800, 300);
+
+        // Messages arrived before the window was created
+        applyFilter();
     }
-    console->show();
-    return console;
+    c.window->show();
+    return c.view;
 }
 
-QString sanitizeHtml(const QString& msg)
+void appendMessage(const Message& msg)
 {
-    return QString(msg).replace("<", "&lt;").replace(">", "&gt;").replace("\n", "<br>");
+    Console& c = console();
+    c.index.append(msg);
+    if (!c.window)
+    {
+        // New window renders the whole filtered history including this message
+        consoleWindow();
+        return;
+    }
+    c.window->show();
+    if (MessageIndex::matches(msg, c.query))
+        c.view->append(formatMessage(msg));
 }
 
 bool mayInoreMessage(const QString& message)
@@ -56,15 +167,14 @@ void messageHandler(QtMsgType type, const QMessageLogContext &context, const QSt
 {
     if (mayInoreMessage(message)) return;
 
-    QString msg = QString("<p><b>%1</b>: %2").arg(messageType(type), sanitizeHtml(message));
-
-    // Messages inside of Qt-code has no context filled
-    // but function info already built into the message text
+    Message msg { type, message, QString(), QString(), 0 };
     if (context.file)
-        msg += QString("<br><font color=gray>(%1:%2, %3</font>")
-            .arg(context.file).arg(context.line).arg(context.function);
-
-    consoleWindow()->append(msg);
+    {
+        msg.file = QString::fromUtf8(context.file);
+        msg.function = QString::fromUtf8(context.function);
+        msg.line = context.line;
+    }
+    appendMessage(msg);
 }
 #else
 void messageHandler(QtMsgType type, const char* msg)
@@ -73,7 +183,7 @@ void messageHandler(QtMsgType type, const char* msg)
 
     if (mayInoreMessage(message)) return;
 
-    consoleWindow()->append(QString("<p><b>%1</b>: %2<br>").arg(messageType(type)).arg(sanitizeHtml(message)));
+    appendMessage(Message { type, message, QString(), QString(), 0 });
 }
 #endif
 
@@ -0,0 +1,184 @@
+#include "OriFuzzyIndex.h"
+
+#include <QVarLengthArray>
+
+#include <limits>
+
+namespace Ori {
+
+namespace {
+
+inline quint64 charMask(const QString& folded)
+{
+    quint64 mask = 0;
+    for (const QChar& c : folded)
+        mask |= quint64(1) << (c.unicode() % 64);
+    return mask;
+}
+
+inline bool isWordSeparator(QChar c)
+{
+    return c == '/' || c == '\\' || c == ' ' || c == '_' || c == '-' || c == '.';
+}
+
+struct Candidate
+{
+    int score;
+    quint64 rank;
+    int slot;
+
+    bool betterThan(const Candidate& other) const
+    {
+        return score > other.score || (score == other.score && rank > other.rank);
+    }
+};
+
+} // namespace
+
+FuzzyIndex::Entry FuzzyIndex::makeEntry(const QString& text, quint64 rank)
+{
+    Entry entry;
+    entry.text = text;
+    entry.folded = text.toLower();
+    entry.mask = charMask(entry.folded);
+    entry.rank = rank;
+    entry.nameStart = qMax(text.lastIndexOf('/'), text.lastIndexOf('\\')) + 1;
+    return entry;
+}
+
+void FuzzyIndex::insert(const QString& text, quint64 rank)
+{
+    auto it = _slots.constFind(text);
+    if (it != _slots.constEnd())
+    {
+        _entries[it.value()].rank = rank;
+        return;
+    }
+    _slots.insert(text, _entries.size());
+    _entries.append(makeEntry(text, rank));
+}
+
+void FuzzyIndex::remove(const QString& text)
+{
+    auto it = _slots.find(text);
+    if (it == _slots.end()) return;
+
+    // The last entry takes place of the removed one, so removing costs O(1)
+    int slot = it.value();
+    _slots.erase(it);
+    int last = _entries.size() - 1;
+    if (slot != last)
+    {
+        _entries[slot] = _entries.at(last);
+        _slots[_entries.at(slot).text] = slot;
+    }
+    _entries.removeLast();
+}
+
+void FuzzyIndex::clear()
+{
+    _entries.clear();
+    _slots.clear();
+}
+
+int FuzzyIndex::score(const QString& text, const QString& pattern)
+{
+    return score(makeEntry(text, 0), pattern.toLower());
+}
+
+int FuzzyIndex::score(const Entry& entry, const QString& foldedPattern)
+{
+    const QChar* folded = entry.folded.constData();
+    const QChar* text = entry.text.constData();
+    const QChar* pattern = foldedPattern.constData();
+    int len = entry.folded.size();
+    int patternLen = foldedPattern.size();
+    if (patternLen == 0) return -qMin(len, 100);
+
+    // Greedy pass cheaply rejects texts not containing the pattern
+    for (int i = 0, pos = 0; i < patternLen; i++, pos++)
+    {
+        while (pos < len && folded[pos] != pattern[i]) pos++;
+        if (pos == len) return -1;
+    }
+
+    auto charScore = [&](int pos){
+        int s = 1;
+        if (pos == 0 || isWordSeparator(text[pos-1]) || (text[pos].isUpper() && text[pos-1].isLower()))
+            s += 8;
+        if (pos >= entry.nameStart)
+            s += 4;
+        return s;
+    };
+
+    // The first match of each char is not always the best one, e.g. `mainw` in `/projects/demo/MainWindow.cpp`
+    // should not take `m` from `demo`. So the best alignment is found: prev[pos] is the best score
+    // of matching the pattern up to the previous char, with that char matched at `pos`
+    const int none = std::numeric_limits<int>::min() / 2;
+    QVarLengthArray<int, 512> rows(len * 2);
+    int* prev = rows.data();
+    int* cur = prev + len;
+    for (int pos = 0; pos < len; pos++)
+        prev[pos] = folded[pos] == pattern[0] ? charScore(pos) : none;
+    for (int i = 1; i < patternLen; i++)
+    {
+        int bestBefore = none;
+        for (int pos = 0; pos < len; pos++)
+        {
+            cur[pos] = none;
+            if (pos > 0) bestBefore = qMax(bestBefore, prev[pos-1]);
+            if (folded[pos] != pattern[i]) continue;
+            int base = bestBefore;
+            if (pos > 0 && prev[pos-1] > none)
+                base = qMax(base, prev[pos-1] + 5); // consecutive chars
+            if (base > none)
+                cur[pos] = base + charScore(pos);
+        }
+        std::swap(prev, cur);
+    }
+    int score = none;
+    for (int pos = 0; pos < len; pos++)
+        score = qMax(score, prev[pos]);
+    if (score <= none) return -1;
+
+    // Shorter texts are a bit more preferable
+    return score * 10 - qMin(len - patternLen, 100);
+}
+
+QStringList FuzzyIndex::match(const QString& pattern, int limit) const
+{
+    QStringList result;
+    if (limit <= 0) return result;
+
+    QString foldedPattern = pattern.toLower();
+    quint64 patternMask = charMask(foldedPattern);
+
+    // Best candidates sorted from the best one, there are only a few of them,
+    // so it's cheaper to keep them sorted by insertion than to sort all matches
+    QVector<Candidate> best;
+    best.reserve(limit + 1);
+    for (int slot = 0; slot < _entries.size(); slot++)
+    {
+        const Entry& entry = _entries.at(slot);
+        if ((entry.mask & patternMask) != patternMask) continue;
+
+        Candidate candidate { 0, entry.rank, slot };
+        if (!foldedPattern.isEmpty())
+        {
+            candidate.score = score(entry, foldedPattern);
+            if (candidate.score < 0) continue;
+        }
+        if (best.size() == limit && !candidate.betterThan(best.last())) continue;
+
+        int pos = best.size();
+        while (pos > 0 && candidate.betterThan(best.at(pos-1))) pos--;
+        best.insert(pos, candidate);
+        if (best.size() > limit) best.removeLast();
+    }
+
+    for (const Candidate& candidate : best)
+        result << _entries.at(candidate.slot).text;
+    return result;
+}
+
+} // namespace Ori
@@ -0,0 +1,57 @@
+#ifndef ORI_FUZZY_INDEX_H
+#define ORI_FUZZY_INDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Ori {
+
+/** Index of strings for quick-open like fuzzy search.
+    A string matches a pattern when all characters of the pattern are found
+    in the string in the same order (case insensitive). Matches are scored higher
+    for consecutive characters and for characters at word starts or in file names,
+    the score of the best placement of pattern characters in the string is taken.
+    Folded texts and character masks are calculated once when strings are inserted,
+    and most of non-matching strings are rejected by comparing masks only.
+*/
+class FuzzyIndex
+{
+public:
+    /// Inserts the text or updates its rank if the text is already in the index.
+    /// Rank is used to order matches having the same score, higher rank goes first.
+    void insert(const QString& text, quint64 rank);
+    void remove(const QString& text);
+    void clear();
+
+    int size() const { return _entries.size(); }
+    bool contains(const QString& text) const { return _slots.contains(text); }
+
+    /// Returns at most limit the best matching texts, the best first.
+    /// For an empty pattern returns texts having the highest ranks.
+    QStringList match(const QString& pattern, int limit) const;
+
+    /// Returns score of matching the text against the pattern, or -1 if it doesn't match.
+    static int score(const QString& text, const QString& pattern);
+
+private:
+    struct Entry
+    {
+        QString text;
+        QString folded;
+        quint64 mask;
+        quint64 rank;
+        int nameStart;
+    };
+
+    QVector<Entry> _entries;
+    QHash<QString, int> _slots;
+
+    static Entry makeEntry(const QString& text, quint64 rank);
+    static int score(const Entry& entry, const QString& foldedPattern);
+};
+
+} // namespace Ori
+
+#endif // ORI_FUZZY_INDEX_H
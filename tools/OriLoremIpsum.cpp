@@ -1,10 +1,17 @@
 #include "OriLoremIpsum.h"
 
+#include "../core/OriRandom.h"
+
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
 
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-#include <QRandomGenerator>
-#endif
+#include <memory>
+#include <vector>
 
 namespace LoremIpsum {
 
@@ -84,15 +91,14 @@ const QList<QString>& domains()
     return items;
 }
 
+QString getItem(const QList<QString>& list, Ori::Random& rnd)
+{
+    return list.at(int(rnd.bounded(quint32(list.size()))));
+}
+
 QString getItem(const QList<QString>& list)
 {
-    return list.at(
-    #if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
-        QRandomGenerator::global()->generate()
-    #else
-        qrand()
-    #endif
-        % list.size());
+    return getItem(list, Ori::Random::local());
 }
 
 QString makeText(int numWords)
@@ -105,11 +111,16 @@ QString makeText(int numWords)
 }
 
 QString makeWords(int count, WordOption option)
+{
+    return makeWords(count, option, Ori::Random::local());
+}
+
+QString makeWords(int count, WordOption option, Ori::Random& rnd)
 {
     QStringList strs;
     for (int i = 0; i < count; i++)
     {
-        auto word = getItem(words());
+        auto word = getItem(words(), rnd);
         if (option == CamelCase)
             word[0] = word[0].toUpper();
         strs << word;
@@ -122,7 +133,175 @@ QString makeWords(int count, WordOption option)
 
 QString makeEmail()
 {
-   return QString("%1@%2.%3").arg(getItem(words()), getItem(words()), getItem(domains()));
+   return makeEmail(Ori::Random::local());
+}
+
+QString makeEmail(Ori::Random& rnd)
+{
+   // Order of evaluating arguments is unspecified, so items are taken one by one
+   // to get the same email for the same state of the generator on any compiler
+   QString name = getItem(words(), rnd);
+   QString host = getItem(words(), rnd);
+   QString domain = getItem(domains(), rnd);
+   return QString("%1@%2.%3").arg(name, host, domain);
+}
+
+//------------------------------------------------------------------------------
+//                              Streaming
+//------------------------------------------------------------------------------
+
+namespace {
+
+const QVector<QByteArray>& wordBytes()
+{
+    static QVector<QByteArray> items = []{
+        QVector<QByteArray> items;
+        for (const QString& word : words())
+            items << word.toLatin1();
+        return items;
+    }();
+    return items;
+}
+
+struct Chunk
+{
+    QByteArray text;
+    qint64 words = 0;
+    QSemaphore ready;
+};
+
+// Makes paragraphs of 3..7 sentences of 6..15 words until the chunk size is reached
+void generateChunk(Chunk* chunk, quint64 seed, quint64 index, int chunkSize)
+{
+    const auto& words = wordBytes();
+    // Each chunk has its own generator, so threads don't share anything
+    Ori::Random rnd(seed, index);
+    QByteArray& text = chunk->text;
+    text.reserve(chunkSize + 1024);
+    qint64 wordCount = 0;
+    while (text.size() < chunkSize)
+    {
+        int sentences = 3 + rnd.bounded(5);
+        for (int s = 0; s < sentences; s++)
+        {
+            int wordsInSentence = 6 + rnd.bounded(10);
+            for (int w = 0; w < wordsInSentence; w++)
+            {
+                const QByteArray& word = words.at(rnd.bounded(words.size()));
+                int pos = text.size();
+                text.append(word);
+                if (w == 0)
+                    text[pos] = char(text.at(pos) - 'a' + 'A');
+                text.append(w == wordsInSentence-1 ? '.' : ' ');
+            }
+            wordCount += wordsInSentence;
+            text.append(s == sentences-1 ? '\n' : ' ');
+        }
+    }
+    chunk->words = wordCount;
+}
+
+class ChunkTask : public QRunnable
+{
+public:
+    ChunkTask(Chunk* chunk, quint64 seed, quint64 index, int chunkSize)
+        : _chunk(chunk), _seed(seed), _index(index), _chunkSize(chunkSize) {}
+
+    void run() override
+    {
+        generateChunk(_chunk, _seed, _index, _chunkSize);
+        _chunk->ready.release();
+    }
+
+private:
+    Chunk* _chunk;
+    quint64 _seed, _index;
+    int _chunkSize;
+};
+
+qint64 countWords(const QByteArray& text)
+{
+    qint64 count = 0;
+    bool inWord = false;
+    for (char c : text)
+    {
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (letter && !inWord) count++;
+        inWord = letter;
+    }
+    return count;
+}
+
+} // namespace
+
+double StreamStats::megabytesPerSecond() const
+{
+    return elapsedNs > 0 ? (bytes / 1048576.0) / (elapsedNs / 1e9) : 0;
+}
+
+StreamStats streamText(const TextSink& sink, const StreamOptions& options)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    StreamStats stats;
+    if (options.size <= 0) return stats;
+
+    // Each chunk is at least of chunkSize, so the number of chunks is known in advance
+    const int chunkSize = qMax(options.chunkSize, 1024);
+    const qint64 chunkCount = (options.size + chunkSize - 1) / chunkSize;
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    // Some chunks are generated ahead, so the threads keep working while the sink writes
+    std::vector<std::unique_ptr<Chunk>> window;
+    const qint64 windowSize = qMin(chunkCount, qint64(threads) * 2);
+    for (qint64 i = 0; i < windowSize; i++)
+    {
+        window.emplace_back(new Chunk);
+        pool.start(new ChunkTask(window.back().get(), options.seed, quint64(i), chunkSize));
+    }
+
+    for (qint64 i = 0; i < chunkCount; i++)
+    {
+        std::unique_ptr<Chunk>& chunk = window[size_t(i % windowSize)];
+        chunk->ready.acquire();
+
+        QByteArray text;
+        text.swap(chunk->text);
+        qint64 words = chunk->words;
+        if (stats.bytes + text.size() > options.size)
+        {
+            text.truncate(int(options.size - stats.bytes));
+            words = countWords(text);
+        }
+
+        qint64 next = i + windowSize;
+        if (next < chunkCount)
+        {
+            chunk.reset(new Chunk);
+            pool.start(new ChunkTask(chunk.get(), options.seed, quint64(next), chunkSize));
+        }
+
+        stats.bytes += text.size();
+        stats.words += words;
+        if (!sink(text) || stats.bytes >= options.size)
+            break;
+    }
+    // Chunks still being generated after stopping must not be deleted under the threads
+    pool.waitForDone();
+
+    stats.elapsedNs = timer.nsecsElapsed();
+    return stats;
+}
+
+StreamStats streamText(QIODevice* device, const StreamOptions& options)
+{
+    return streamText([device](const QByteArray& chunk){
+        return device->write(chunk) == chunk.size();
+    }, options);
 }
 
 } // namespace LoremIpsum
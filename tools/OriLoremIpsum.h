@@ -1,8 +1,19 @@
 #ifndef ORI_LOREM_IPSUM_H
 #define ORI_LOREM_IPSUM_H
 
+#include <QByteArray>
 #include <QString>
 
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace Ori {
+class Random;
+}
+
 namespace LoremIpsum
 {
 
@@ -12,6 +23,38 @@ QString makeText(int numWords);
 QString makeWords(int count, WordOption option = None);
 QString makeEmail();
 
+/// Overloads taking the generator explicitly, the same generator state gives the same result.
+QString makeWords(int count, WordOption option, Ori::Random& rnd);
+QString makeEmail(Ori::Random& rnd);
+
+/// Receives generated text in chunks, returns false to stop the generation.
+using TextSink = std::function<bool(const QByteArray& chunk)>;
+
+struct StreamOptions
+{
+    qint64 size = 0;         ///< Total size of text in bytes
+    quint64 seed = 0;        ///< The same seed gives the same text
+    int threads = 0;         ///< Number of generating threads, 0 means QThread::idealThreadCount()
+    int chunkSize = 1 << 20; ///< Text is made of independently generated chunks of about this size
+};
+
+struct StreamStats
+{
+    qint64 bytes = 0;
+    qint64 words = 0;
+    qint64 elapsedNs = 0;
+
+    double megabytesPerSecond() const;
+};
+
+/// Generates text of paragraphs of sentences of random words (in Latin1/UTF-8) and passes it
+/// to the sink in chunks. Chunks are generated in parallel, each one by its own generator
+/// seeded by the seed and the index of the chunk, and they are passed to the sink in order
+/// from the calling thread. So the text depends only on the seed and the chunk size,
+/// but not on the number of threads.
+StreamStats streamText(const TextSink& sink, const StreamOptions& options);
+StreamStats streamText(QIODevice* device, const StreamOptions& options);
+
 } // namespace LoremIpsum
 
 #endif // ORI_LOREM_IPSUM_H
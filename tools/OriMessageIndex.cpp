@@ -0,0 +1,174 @@
+#include "OriMessageIndex.h"
+
+#include <algorithm>
+
+namespace Ori {
+namespace Debug {
+
+namespace {
+
+inline quint64 trigramKey(const QChar* s)
+{
+    return (quint64(s[0].unicode()) << 32) | (quint64(s[1].unicode()) << 16) | quint64(s[2].unicode());
+}
+
+QVector<quint64> trigrams(const QString& text)
+{
+    QVector<quint64> keys;
+    QString s = text.toLower();
+    if (s.size() < 3) return keys;
+    keys.reserve(s.size() - 2);
+    const QChar* data = s.constData();
+    for (int i = 0; i < s.size() - 2; i++)
+        keys.append(trigramKey(data + i));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+QVector<int> intersect(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> result;
+    std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(),
+                          std::back_inserter(result));
+    return result;
+}
+
+QVector<int> unite(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> result;
+    result.reserve(a.size() + b.size());
+    std::set_union(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(),
+                   std::back_inserter(result));
+    return result;
+}
+
+// There are much less distinct files and functions than messages,
+// so it's cheap enough to check all of them against the pattern.
+QVector<int> byOrigin(const QHash<QString, QVector<int>>& index, const QString& pattern)
+{
+    QVector<int> result;
+    for (auto it = index.constBegin(); it != index.constEnd(); it++)
+        if (it.key().contains(pattern, Qt::CaseInsensitive))
+            result = result.isEmpty() ? it.value() : unite(result, it.value());
+    return result;
+}
+
+} // namespace
+
+int MessageIndex::append(const Message& msg)
+{
+    int id = _messages.size();
+    _messages.append(msg);
+
+    _byType[msg.type].append(id);
+    if (!msg.file.isEmpty())
+        _byFile[msg.file].append(id);
+    if (!msg.function.isEmpty())
+        _byFunction[msg.function].append(id);
+    for (quint64 key : trigrams(msg.text))
+        _trigrams[key].append(id);
+
+    return id;
+}
+
+void MessageIndex::clear()
+{
+    _messages.clear();
+    _byType.clear();
+    _byFile.clear();
+    _byFunction.clear();
+    _trigrams.clear();
+}
+
+QVector<int> MessageIndex::trigramCandidates(const QString& text, bool* indexed) const
+{
+    auto keys = trigrams(text);
+    *indexed = !keys.isEmpty();
+    if (keys.isEmpty()) return QVector<int>();
+
+    QList<const QVector<int>*> lists;
+    for (quint64 key : keys)
+    {
+        auto it = _trigrams.constFind(key);
+        if (it == _trigrams.constEnd())
+            return QVector<int>(); // no message can contain the text
+        lists.append(&it.value());
+    }
+
+    // Starting from the shortest list keeps intermediate results small
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b){
+        return a->size() < b->size();
+    });
+    QVector<int> result = *lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); i++)
+        result = intersect(result, *lists.at(i));
+    return result;
+}
+
+bool MessageIndex::matches(const Message& msg, const MessageQuery& query)
+{
+    if (!query.types.isEmpty() && !query.types.contains(msg.type))
+        return false;
+    if (!query.file.isEmpty() && !msg.file.contains(query.file, Qt::CaseInsensitive))
+        return false;
+    if (!query.function.isEmpty() && !msg.function.contains(query.function, Qt::CaseInsensitive))
+        return false;
+    if (!query.text.isEmpty() && !msg.text.contains(query.text, Qt::CaseInsensitive))
+        return false;
+    return true;
+}
+
+QVector<int> MessageIndex::search(const QString& text) const
+{
+    MessageQuery query;
+    query.text = text;
+    return filter(query);
+}
+
+QVector<int> MessageIndex::filter(const MessageQuery& query, int limit) const
+{
+    // Each criterion gives a sorted list of candidates, the shortest one is taken
+    // and its items are verified against all the criteria. When no criterion
+    // is indexed (e.g. the search text is shorter than a trigram), all messages are checked.
+    QVector<QVector<int>> candidates;
+    if (!query.types.isEmpty())
+    {
+        QVector<int> ids;
+        for (QtMsgType type : query.types)
+            ids = ids.isEmpty() ? byType(type) : unite(ids, byType(type));
+        candidates.append(ids);
+    }
+    if (!query.file.isEmpty())
+        candidates.append(byOrigin(_byFile, query.file));
+    if (!query.function.isEmpty())
+        candidates.append(byOrigin(_byFunction, query.function));
+    if (!query.text.isEmpty())
+    {
+        bool indexed;
+        auto ids = trigramCandidates(query.text, &indexed);
+        if (indexed) candidates.append(ids);
+    }
+
+    const QVector<int>* shortest = nullptr;
+    for (const QVector<int>& ids : candidates)
+        if (!shortest || ids.size() < shortest->size())
+            shortest = &ids;
+
+    QVector<int> result;
+    int total = shortest ? shortest->size() : _messages.size();
+    for (int i = total-1; i >= 0; i--)
+    {
+        int id = shortest ? shortest->at(i) : i;
+        if (matches(_messages.at(id), query))
+        {
+            result.append(id);
+            if (limit > 0 && result.size() >= limit) break;
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+} // namespace Debug
+} // namespace Ori
@@ -0,0 +1,77 @@
+#ifndef ORI_MESSAGE_INDEX_H
+#define ORI_MESSAGE_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Ori {
+namespace Debug {
+
+struct Message
+{
+    QtMsgType type;
+    QString text;
+    QString file;
+    QString function;
+    int line;
+};
+
+/// Set of criteria for MessageIndex::filter().
+/// Empty criteria are not applied. File, function and text are matched
+/// as case insensitive substrings, e.g. just a class name can be given as function.
+struct MessageQuery
+{
+    QList<QtMsgType> types;
+    QString file;
+    QString function;
+    QString text;
+};
+
+/** Incrementally built index of debug messages.
+    Messages are indexed by type, source file and function at the time of appending,
+    and their texts are split into trigrams so that a substring search only has
+    to verify messages containing all trigrams of the search string.
+    Message ids are their ordinal numbers, so all id lists are sorted ascending.
+*/
+class MessageIndex
+{
+public:
+    int append(const Message& msg);
+    void clear();
+
+    int count() const { return _messages.size(); }
+    const Message& message(int id) const { return _messages.at(id); }
+
+    QVector<int> byType(QtMsgType type) const { return _byType.value(type); }
+    QVector<int> byFile(const QString& file) const { return _byFile.value(file); }
+    QVector<int> byFunction(const QString& function) const { return _byFunction.value(function); }
+
+    /// Returns ids of messages containing the text (case insensitive).
+    QVector<int> search(const QString& text) const;
+
+    /// Returns ids of messages satisfying all criteria of the query.
+    /// If limit is given, only that number of the most recent matching ids is returned.
+    QVector<int> filter(const MessageQuery& query, int limit = -1) const;
+
+    QStringList files() const { return _byFile.keys(); }
+    QStringList functions() const { return _byFunction.keys(); }
+
+    static bool matches(const Message& msg, const MessageQuery& query);
+
+private:
+    QVector<Message> _messages;
+    QHash<int, QVector<int>> _byType;
+    QHash<QString, QVector<int>> _byFile;
+    QHash<QString, QVector<int>> _byFunction;
+    QHash<quint64, QVector<int>> _trigrams;
+
+    QVector<int> trigramCandidates(const QString& text, bool* indexed) const;
+};
+
+} // namespace Debug
+} // namespace Ori
+
+#endif // ORI_MESSAGE_INDEX_H
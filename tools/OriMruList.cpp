@@ -4,9 +4,14 @@
 #include <QAction>
 #include <QApplication>
 #include <QDebug>
+#include <QDir>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QMessageBox>
 #include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
 
 namespace Ori {
 
@@ -21,55 +26,112 @@ MruList::MruList(QObject *parent): QObject(parent)
 
     _actionClearInvalids = new QAction(tr("Delete Invalid Items"), this);
     connect(_actionClearInvalids, SIGNAL(triggered()), this, SLOT(clearInvalids()));
+
+    connect(this, SIGNAL(itemStateChanged(QString)), this, SLOT(stateChanged(QString)));
+
+    // Bulk changes, e.g. opening of many files at once, are saved at once
+    _saveTimer = new QTimer(this);
+    _saveTimer->setSingleShot(true);
+    _saveTimer->setInterval(500);
+    connect(_saveTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(flush()));
+}
+
+MruList::~MruList()
+{
+    flush();
+}
+
+void MruList::flush()
+{
+    if (!_savePending) return;
+    _savePending = false;
+    _saveTimer->stop();
+    save();
 }
 
 void MruList::append(const QString& item)
 {
     if (item.isEmpty()) return;
 
-    auto a = action(item);
-    if (a)
-        _actions.removeOne(a);
+    QString key = itemKey(item);
+    auto it = _index.constFind(key);
+    if (it != _index.constEnd())
+    {
+        // Moving of a list node doesn't invalidate iterators stored in the index
+        Entries::iterator entry = it.value();
+        _entries.splice(_entries.begin(), _entries, entry);
+        _fuzzy.insert(entry->item, ++_rank);
+    }
     else
-        a = makeAction(item);
-    _actions.prepend(a);
-    trimActions();
+    {
+        _entries.push_front(Entry { item, key, nullptr });
+        _index.insert(key, _entries.begin());
+        _fuzzy.insert(item, ++_rank);
+    }
+    _itemsValid = false;
+    trimItems();
     update();
 }
 
+const QStringList& MruList::items() const
+{
+    if (!_itemsValid)
+    {
+        _items.clear();
+        _items.reserve(_index.size());
+        for (const Entry& entry : _entries)
+            _items.append(entry.item);
+        _itemsValid = true;
+    }
+    return _items;
+}
+
 QAction* MruList::action(const QString& item) const
 {
-    int index = indexOf(item);
-    return index >= 0? _actions.at(index): nullptr;
+    auto it = _index.constFind(itemKey(item));
+    return it == _index.constEnd() ? nullptr : it.value()->action;
 }
 
-int MruList::indexOf(const QString& item) const
+QString MruList::itemKey(const QString& item) const
 {
-    for (int i = 0; i < _actions.size(); i++)
-        if (sameItems(_actions.at(i)->text(), item))
-            return i;
-    return -1;
+    return item;
 }
 
 bool MruList::sameItems(const QString& item1, const QString& item2) const
 {
-    return item1 == item2;
+    return itemKey(item1) == itemKey(item2);
 }
 
 void MruList::load(const QString &key)
 {
     Ori::Settings s;
-    load(s.settings(), key);
+    _settingGroup = s.group();
+    _settingsKey = key.isEmpty()? "mru": key;
+    loadItems(s.value(_settingsKey).toStringList());
 }
 
 void MruList::load(QSettings* settings, const QString& key)
 {
     _settingGroup = settings->group();
     _settingsKey = key.isEmpty()? "mru": key;
-    auto items = settings->value(_settingsKey).toStringList();
+    loadItems(settings->value(_settingsKey).toStringList());
+}
+
+void MruList::loadItems(const QStringList& items)
+{
     for (const QString& item : items)
-        if (_maxCount < 0 || _actions.size() < _maxCount)
-            _actions.append(makeAction(item));
+    {
+        if (_maxCount >= 0 && _index.size() >= _maxCount) break;
+        QString key = itemKey(item);
+        if (_index.contains(key)) continue;
+        _entries.push_back(Entry { item, key, nullptr });
+        _index.insert(key, std::prev(_entries.end()));
+    }
+    _itemsValid = false;
+    // The first item is the most recent one
+    for (auto it = _entries.rbegin(); it != _entries.rend(); it++)
+        _fuzzy.insert(it->item, ++_rank);
     update();
 }
 
@@ -84,12 +146,9 @@ void MruList::save()
     }
 }
 
-QStringList MruList::items() const
+QStringList MruList::match(const QString& pattern, int limit) const
 {
-    QStringList list;
-    foreach (const QAction* action, _actions)
-        list.append(action->text());
-    return list;
+    return _fuzzy.match(pattern, limit);
 }
 
 QAction* MruList::makeAction(const QString &item)
@@ -99,12 +158,51 @@ QAction* MruList::makeAction(const QString &item)
     return action;
 }
 
+void MruList::removeEntry(Entries::iterator entry)
+{
+    if (entry->action)
+    {
+        _actions.removeOne(entry->action);
+        delete entry->action;
+    }
+    _index.remove(entry->key);
+    _fuzzy.remove(entry->item);
+    _entries.erase(entry);
+    _itemsValid = false;
+}
+
+void MruList::updateActions()
+{
+    int count = _menuCount < 0 ? _index.size() : qMin(_menuCount, _index.size());
+
+    // Items having actions always go first, so only a few items
+    // just after the shown ones can have actions to be deleted
+    QList<QAction*> actions;
+    actions.reserve(count);
+    auto it = _entries.begin();
+    for (int i = 0; i < count; i++, it++)
+    {
+        if (!it->action)
+            it->action = makeAction(it->item);
+        actions.append(it->action);
+    }
+    for (; it != _entries.end() && it->action; it++)
+    {
+        delete it->action;
+        it->action = nullptr;
+    }
+    _actions = actions;
+}
+
 void MruList::update()
 {
-    _actionClearAll->setEnabled(!_actions.empty());
-    _actionClearInvalids->setEnabled(!_actions.empty());
+    updateActions();
 
-    save();
+    _actionClearAll->setEnabled(!_index.isEmpty());
+    _actionClearInvalids->setEnabled(!_index.isEmpty());
+
+    _savePending = true;
+    _saveTimer->start();
 
     emit changed();
 }
@@ -126,19 +224,40 @@ void MruList::actionTriggered()
 
 void MruList::clearAll()
 {
-    foreach (QAction *a, _actions) delete a;
+    qDeleteAll(_actions);
     _actions.clear();
+    _entries.clear();
+    _index.clear();
+    _items.clear();
+    _itemsValid = true;
+    _fuzzy.clear();
     update();
 }
 
 void MruList::clearInvalids()
 {
-    auto invalids = invalidItems();
-    for (auto action : invalids)
+    _clearInvalidsRequested = true;
+    removeInvalids();
+}
+
+void MruList::removeInvalids()
+{
+    bool complete = true;
+    QVector<Entries::iterator> invalids;
+    for (auto it = _entries.begin(); it != _entries.end(); it++)
     {
-        _actions.removeOne(action);
-        delete action;
+        auto state = itemState(it->item);
+        if (state == ItemUnknown)
+            complete = false;
+        else if (state == ItemInvalid)
+            invalids.append(it);
     }
+    // Will be continued when the rest of states come
+    if (!complete) return;
+
+    _clearInvalidsRequested = false;
+    for (auto entry : invalids)
+        removeEntry(entry);
     QString msg;
     if (invalids.size() > 0)
     {
@@ -150,42 +269,178 @@ void MruList::clearInvalids()
     QMessageBox::information(qApp->activeWindow(), qApp->applicationName(), msg);
 }
 
-QList<QAction*> MruList::invalidItems() const
+MruList::ItemState MruList::itemState(const QString& item) const
+{
+    return validateItem(item) ? ItemValid : ItemInvalid;
+}
+
+void MruList::checkItems()
 {
-    QList<QAction*> list;
     for (auto action : _actions)
-        if (!validateItem(action->text()))
-            list.append(action);
-    return list;
+        itemState(action->text());
+}
+
+void MruList::stateChanged(const QString& item)
+{
+    auto a = action(item);
+    if (a) a->setEnabled(itemState(item) != ItemInvalid);
+
+    if (_clearInvalidsRequested)
+        removeInvalids();
 }
 
 void MruList::setMaxCount(int value)
 {
     _maxCount = value;
-    trimActions();
+    trimItems();
 }
 
-void MruList::trimActions()
+void MruList::setMenuCount(int value)
+{
+    if (_menuCount == value) return;
+    _menuCount = value;
+    updateActions();
+    emit changed();
+}
+
+void MruList::trimItems()
 {
     if (_maxCount < 0) return;
-    int prevCount = _actions.size();
-    while (_actions.size() > _maxCount)
+    int prevCount = _index.size();
+    while (_index.size() > _maxCount)
+        removeEntry(std::prev(_entries.end()));
+    if (prevCount != _index.size())
     {
-        auto a = _actions.last();
-        _actions.removeLast();
-        delete a;
-    }
-    if (prevCount != _actions.size())
+        updateActions();
         emit changed();
+    }
+}
+
+//------------------------------------------------------------------------------
+//                             MruFileValidator
+//------------------------------------------------------------------------------
+
+namespace {
+
+void stopValidatorThread();
+
+QThread* validatorThread()
+{
+    static QThread* thread = nullptr;
+    if (!thread)
+    {
+        thread = new QThread;
+        thread->setObjectName("MruFileValidator");
+        thread->start();
+        qAddPostRoutine(stopValidatorThread);
+    }
+    return thread;
+}
+
+void stopValidatorThread()
+{
+    // The thread is not deleted because it can still hang on an unavailable network path
+    auto thread = validatorThread();
+    thread->quit();
+    thread->wait(1000);
+}
+
+} // namespace
+
+void MruFileValidator::check(const QStringList& files)
+{
+    if (!_watcher)
+    {
+        _watcher = new QFileSystemWatcher(this);
+        connect(_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+    }
+    for (const QString& file : files)
+    {
+        QString dir = QFileInfo(file).absolutePath();
+        auto it = _dirFiles.find(dir);
+        if (it == _dirFiles.end() && QFileInfo::exists(dir) && _watcher->addPath(dir))
+            it = _dirFiles.insert(dir, QSet<QString>());
+        if (it != _dirFiles.end())
+            it->insert(file);
+        emit checked(file, QFile::exists(file));
+    }
+}
+
+void MruFileValidator::directoryChanged(const QString& dir)
+{
+    auto it = _dirFiles.find(dir);
+    if (it == _dirFiles.end()) return;
+
+    QSet<QString> files = it.value();
+    // Watcher stops watching a removed directory by itself,
+    // it will be watched again when its files are checked next time
+    if (!QFileInfo::exists(dir))
+        _dirFiles.erase(it);
+    for (const QString& file : files)
+        emit checked(file, QFile::exists(file));
 }
 
 //------------------------------------------------------------------------------
 //                               MruFileList
 //------------------------------------------------------------------------------
 
-bool MruFileList::sameItems(const QString& item1, const QString& item2) const
+MruFileList::MruFileList(QObject *parent) : MruList(parent)
+{
+    _clock.start();
+
+    _validator = new MruFileValidator;
+    _validator->moveToThread(validatorThread());
+    connect(this, SIGNAL(checkRequested(QStringList)), _validator, SLOT(check(QStringList)));
+    connect(_validator, SIGNAL(checked(QString,bool)), this, SLOT(fileChecked(QString,bool)));
+}
+
+MruFileList::~MruFileList()
+{
+    _validator->deleteLater();
+}
+
+MruList::ItemState MruFileList::itemState(const QString& item) const
+{
+    auto it = _states.constFind(item);
+    bool actual = it != _states.constEnd() && _clock.elapsed() - it->checkedAt < _validationTtl;
+    if (!actual && !_pending.contains(item))
+    {
+        // Requests are collected and sent to the validator at once
+        if (_queued.isEmpty())
+            QMetaObject::invokeMethod(const_cast<MruFileList*>(this), "sendQueued", Qt::QueuedConnection);
+        _queued << item;
+        _pending.insert(item);
+    }
+    if (it == _states.constEnd()) return ItemUnknown;
+    return it->exists ? ItemValid : ItemInvalid;
+}
+
+void MruFileList::sendQueued()
+{
+    if (_queued.isEmpty()) return;
+    emit checkRequested(_queued);
+    _queued.clear();
+}
+
+void MruFileList::fileChecked(const QString& file, bool exists)
+{
+    _pending.remove(file);
+    auto it = _states.find(file);
+    bool changed = it == _states.end() || it->exists != exists;
+    _states[file] = FileState { exists, _clock.elapsed() };
+    if (changed)
+        emit itemStateChanged(file);
+}
+
+QString MruFileList::itemKey(const QString& item) const
 {
-    return QFileInfo(item1) == QFileInfo(item2);
+    // Normalize the path textually, without touching the file system
+    QString path = QDir::cleanPath(QDir::isAbsolutePath(item) ? item : QDir::current().absoluteFilePath(item));
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+    return path.toLower();
+#else
+    return path;
+#endif
 }
 
 bool MruFileList::validateItem(const QString& item) const
@@ -195,7 +450,11 @@ bool MruFileList::validateItem(const QString& item) const
 
 bool MruFileList::canClick(const QString& item) const
 {
-    if (!validateItem(item))
+    auto state = itemState(item);
+    // The file is going to be opened anyway, so there is no reason to not wait for the check
+    if (state == ItemUnknown)
+        state = validateItem(item) ? ItemValid : ItemInvalid;
+    if (state == ItemInvalid)
     {
         QMessageBox::critical(qApp->activeWindow(), qApp->applicationName(), tr("File not found"));
         return false;
@@ -1,11 +1,20 @@
 #ifndef ORI_MRU_LIST_H
 #define ORI_MRU_LIST_H
 
+#include "OriFuzzyIndex.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
 #include <QWidget>
 
+#include <list>
+
 QT_BEGIN_NAMESPACE
 class QAction;
+class QFileSystemWatcher;
 class QSettings;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace Ori {
@@ -15,7 +24,10 @@ class MruList : public QObject
     Q_OBJECT
 
 public:
+    enum ItemState { ItemUnknown, ItemValid, ItemInvalid };
+
     explicit MruList(QObject *parent = nullptr);
+    ~MruList() override;
 
     /// Load mru-list from default settings group and specified or default key
     /// Default group and key later used for saving list when new item is appended.
@@ -25,7 +37,12 @@ public:
     /// Opened group and key are preserved and later used for saving list when new item is appended.
     void load(QSettings* settings, const QString &key = QString());
 
-    QStringList items() const;
+    /// Returns all items, the most recent first.
+    /// The list is collected at the first call after changes.
+    const QStringList& items() const;
+    int count() const { return _index.size(); }
+
+    /// Returns actions for items shown in menus, see menuCount().
     const QList<QAction*>& actions() const { return _actions; }
     QAction* actionClearAll() const { return _actionClearAll; }
     QAction* actionClearInvalids() const { return _actionClearInvalids; }
@@ -33,37 +50,118 @@ public:
     int maxCount() const { return _maxCount; }
     void setMaxCount(int value);
 
+    /// Number of the most recent items shown in menus, 10 by default, -1 means all items.
+    /// Actions are created only for these items, so history can be much longer.
+    int menuCount() const { return _menuCount; }
+    void setMenuCount(int value);
+
+    /// Returns items fuzzy matching the pattern, the best matches first,
+    /// see FuzzyIndex for details. It's intended for quick-open boxes.
+    QStringList match(const QString& pattern, int limit = 10) const;
+
+    /// Returns state of the item. Descendants can check items in background,
+    /// then they return the last known state (maybe unknown) and emit
+    /// itemStateChanged() when the check is done.
+    virtual ItemState itemState(const QString& item) const;
+
 public slots:
     void append(const QString& item);
 
+    /// Requests states of all items, see itemState().
+    void checkItems();
+
+    /// Changes of the list are saved to settings with a small delay.
+    /// The function saves pending changes immediately.
+    /// It's called automatically when the application is about to quit.
+    void flush();
+
 signals:
     void clicked(const QString& item);
     void changed();
+    void itemStateChanged(const QString& item);
 
 protected:
-    virtual bool sameItems(const QString& item1, const QString& item2) const;
+    /// Returns a normalized form of the item used for looking it up in the list.
+    /// Items having the same key are considered the same. It's called once per
+    /// appended item, so it should not be expensive.
+    /// It replaces sameItems() as the customization point for comparing items.
+    virtual QString itemKey(const QString& item) const;
+
+    /// Items are compared by their keys, override itemKey() to change the comparison.
+    /// The function is final, so an old override of it fails to compile instead of being ignored.
+    virtual bool sameItems(const QString& item1, const QString& item2) const final;
     virtual bool validateItem(const QString&) const { return true; }
     virtual bool canClick(const QString&) const { return true; }
 
+    /// Writes the list to the settings group and key given to load().
+    /// It's called by flush(), so bulk changes are written at once.
+    virtual void save();
+
 private:
+    struct Entry
+    {
+        QString item;
+        QString key;
+        QAction* action; ///< Only items shown in menus have actions
+    };
+    using Entries = std::list<Entry>;
+
     QString _settingGroup, _settingsKey;
+    Entries _entries; // the most recent first
+    QHash<QString, Entries::iterator> _index; // item key -> entry
+    mutable QStringList _items;
+    mutable bool _itemsValid = true;
+    FuzzyIndex _fuzzy;
+    quint64 _rank = 0;
     QList<QAction*> _actions;
     QAction *_actionClearAll, *_actionClearInvalids;
     int _maxCount = -1;
+    int _menuCount = 10;
+    bool _clearInvalidsRequested = false;
+    bool _savePending = false;
+    QTimer* _saveTimer;
 
     void update();
-    void save();
+    void loadItems(const QStringList& items);
 
-    int indexOf(const QString& item) const;
     QAction* action(const QString& item) const;
     QAction* makeAction(const QString& item);
-    QList<QAction*> invalidItems() const;
-    void trimActions();
+    void updateActions();
+    void removeEntry(Entries::iterator entry);
+    void trimItems();
+    void removeInvalids();
 
 private slots:
     void actionTriggered();
     void clearInvalids();
     void clearAll();
+    void stateChanged(const QString& item);
+};
+
+/// Checks existence of files in a background thread.
+/// Checked files are watched, and changes of their existence are reported too.
+class MruFileValidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    MruFileValidator() {}
+
+public slots:
+    void check(const QStringList& files);
+
+signals:
+    void checked(const QString& file, bool exists);
+
+private:
+    QFileSystemWatcher* _watcher = nullptr;
+
+    // Files are watched through their directories, which are usually shared by many files,
+    // so long lists don't exhaust system watches, and a file appeared again is noticed too
+    QHash<QString, QSet<QString>> _dirFiles;
+
+private slots:
+    void directoryChanged(const QString& dir);
 };
 
 
@@ -72,12 +170,42 @@ class MruFileList : public MruList
     Q_OBJECT
 
 public:
-    explicit MruFileList(QObject *parent = nullptr) : MruList(parent) {}
+    explicit MruFileList(QObject *parent = nullptr);
+    ~MruFileList() override;
+
+    /// Returns the last known state of the file without touching the file system.
+    /// Files are checked in background when their states are unknown
+    /// or have been known for longer than validationTtl().
+    ItemState itemState(const QString& item) const override;
+
+    /// Time in ms during which the result of file check is considered actual.
+    int validationTtl() const { return _validationTtl; }
+    void setValidationTtl(int ms) { _validationTtl = ms; }
+
+signals:
+    void checkRequested(const QStringList& files);
 
 protected:
-    bool sameItems(const QString& item1, const QString& item2) const override;
+    QString itemKey(const QString& item) const override;
     bool validateItem(const QString& item) const override;
     bool canClick(const QString& item) const override;
+
+private:
+    struct FileState
+    {
+        bool exists;
+        qint64 checkedAt;
+    };
+    mutable QHash<QString, FileState> _states;
+    mutable QSet<QString> _pending;
+    mutable QStringList _queued;
+    int _validationTtl = 30000;
+    QElapsedTimer _clock;
+    MruFileValidator* _validator;
+
+private slots:
+    void sendQueued();
+    void fileChecked(const QString& file, bool exists);
 };
 
 } // namespace Ori
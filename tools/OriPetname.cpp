@@ -1,8 +1,11 @@
 #include "OriPetname.h"
 
-#include <QRandomGenerator>
+#include "../core/OriRandom.h"
+
 #include <QStringList>
 
+#include <utility>
+
 namespace OriPetname {
 
 static const int __names_count = 457;
@@ -1183,25 +1186,153 @@ static const char* __adjectives[] = {
     "worthy"
 };
 
-QString randomWord(const char** words, int count) {
-    return QString::fromLatin1(words[QRandomGenerator::global()->generate() % count]);
+QString randomWord(const char** words, int count, Ori::Random& rnd) {
+    return QString::fromLatin1(words[rnd.bounded(quint32(count))]);
 }
 
 QString make(int count, QChar separator)
+{
+    return make(count, separator, Ori::Random::local());
+}
+
+QString make(int count, QChar separator, Ori::Random& rnd)
 {
     if (count <= 1)
-        return randomWord(__names, __names_count);
+        return randomWord(__names, __names_count, rnd);
 
     if (count <= 2)
-        return randomWord(__adjectives, __adjectives_count) +
-            separator + randomWord(__names, __names_count);
+    {
+        // Evaluation order of operands is unspecified, but words must be taken in order
+        QString adjective = randomWord(__adjectives, __adjectives_count, rnd);
+        return adjective + separator + randomWord(__names, __names_count, rnd);
+    }
 
     QStringList strs;
     for (int i = 0; i < count-2; i++)
-        strs << randomWord(__adverbs, __adverbs_count);
-    strs << randomWord(__adjectives, __adjectives_count);
-    strs << randomWord(__names, __names_count);
+        strs << randomWord(__adverbs, __adverbs_count, rnd);
+    strs << randomWord(__adjectives, __adjectives_count, rnd);
+    strs << randomWord(__names, __names_count, rnd);
     return strs.join(separator);
 }
 
+//------------------------------------------------------------------------------
+//                              Unique names
+//------------------------------------------------------------------------------
+
+namespace {
+
+inline quint64 gcd(quint64 a, quint64 b)
+{
+    while (b) { quint64 t = a % b; a = b; b = t; }
+    return a;
+}
+
+// (a*b) mod m for m < 2^40 without 128-bit arithmetic
+inline quint64 mulMod(quint64 a, quint64 b, quint64 m)
+{
+    quint64 high = b >> 20, low = b & 0xFFFFF;
+    return ((a * high % m << 20) % m + a * low) % m;
+}
+
+// Only the first two adverbs take part in the permutation, it gives 14 billions
+// of 4-word names and keeps numbers small enough for 64-bit arithmetic.
+// Further adverbs don't break uniqueness, they are derived from the index.
+const int __uniqueAdverbs = 2;
+
+// Word lists in an order shuffled by seed, the words are converted to strings
+// once, so making a name is just a few appends into a preallocated string
+QVector<QString> shuffledWords(const char** words, int count, Ori::Random& rnd)
+{
+    QVector<QString> result;
+    result.reserve(count);
+    for (int i = 0; i < count; i++)
+        result << QString::fromLatin1(words[i]);
+    for (int i = count-1; i > 0; i--)
+        std::swap(result[i], result[int(rnd.bounded(quint32(i+1)))]);
+    return result;
+}
+
+int maxLength(const QVector<QString>& words)
+{
+    int len = 0;
+    for (const QString& w : words)
+        len = qMax(len, w.size());
+    return len;
+}
+
+} // namespace
+
+quint64 uniqueCount(int count)
+{
+    if (count <= 1) return __names_count;
+    quint64 n = quint64(__names_count) * __adjectives_count;
+    for (int i = 0; i < qMin(count-2, __uniqueAdverbs); i++)
+        n *= __adverbs_count;
+    return n;
+}
+
+int makeUnique(QString* buffer, int total, int count, QChar separator, quint64 seed, quint64 first)
+{
+    count = qMax(count, 1);
+    const quint64 space = uniqueCount(count);
+    if (first >= space || total <= 0) return 0;
+    total = int(qMin(quint64(total), space - first));
+
+    Ori::Random rnd(seed);
+    auto names = shuffledWords(__names, __names_count, rnd);
+    auto adjectives = shuffledWords(__adjectives, __adjectives_count, rnd);
+    auto adverbs = shuffledWords(__adverbs, __adverbs_count, rnd);
+
+    // Affine map i -> (a*i + b) mod space is a permutation when a is coprime to space,
+    // word orders are shuffled additionally, so neighbour names don't look related
+    quint64 a = rnd.next() % space;
+    while (a == 0 || gcd(a, space) != 1) a = (a + 1) % space;
+    quint64 b = rnd.next() % space;
+
+    int adverbCount = count - 2;
+    int len = maxLength(names) + maxLength(adjectives) + adverbCount * maxLength(adverbs) + count;
+
+    for (int i = 0; i < total; i++)
+    {
+        quint64 index = (mulMod(a, first + quint64(i), space) + b) % space;
+
+        QString& s = buffer[i];
+        s.clear();
+        s.reserve(len);
+        const QString& name = names.at(int(index % __names_count));
+        if (count > 1)
+        {
+            index /= __names_count;
+            const QString& adjective = adjectives.at(int(index % __adjectives_count));
+            index /= __adjectives_count;
+            for (int k = 0; k < adverbCount; k++)
+            {
+                quint64 adverb;
+                if (k < __uniqueAdverbs)
+                {
+                    adverb = index % __adverbs_count;
+                    index /= __adverbs_count;
+                }
+                else
+                {
+                    adverb = Ori::Random::mix(first + quint64(i) + quint64(k) * space) % __adverbs_count;
+                }
+                s += adverbs.at(int(adverb));
+                s += separator;
+            }
+            s += adjective;
+            s += separator;
+        }
+        s += name;
+    }
+    return total;
+}
+
+QVector<QString> makeUnique(int total, int count, QChar separator, quint64 seed)
+{
+    QVector<QString> names(int(qMin(quint64(qMax(total, 0)), uniqueCount(count))));
+    makeUnique(names.data(), names.size(), count, separator, seed);
+    return names;
+}
+
 } // namespace OriPetname
@@ -2,13 +2,35 @@
 #define ORI_PETNAME_H
 
 #include <QString>
+#include <QVector>
 
 // https://github.com/lcherone/node-petname
 
+namespace Ori {
+class Random;
+}
+
 namespace OriPetname {
 
 QString make(int count = 2, QChar separator = ' ');
 
+/// Makes a name using the given generator, the same generator state gives the same name.
+QString make(int count, QChar separator, Ori::Random& rnd);
+
+/// Returns the number of distinct names of `count` words available for makeUnique().
+quint64 uniqueCount(int count = 2);
+
+/// Generates unique names of `count` words right into the buffer, which must have room
+/// for `total` strings. Names are taken from a permutation of all combinations of words
+/// defined by the seed, so there are no collisions and no retries, and the same seed gives
+/// the same sequence. `first` is the position in the sequence to start from, it allows
+/// to generate a long sequence in parts. Returns the number of generated names,
+/// it's less than `total` only when the available combinations are exhausted.
+int makeUnique(QString* buffer, int total, int count = 2, QChar separator = ' ',
+               quint64 seed = 0, quint64 first = 0);
+
+QVector<QString> makeUnique(int total, int count = 2, QChar separator = ' ', quint64 seed = 0);
+
 }
 
 #endif // ORI_PETNAME_H
@@ -1,12 +1,472 @@
 #include "OriSettings.h"
 
 #include <QApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QMainWindow>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
 #include <QWidget>
 
 namespace Ori {
 
+//------------------------------------------------------------------------------
+//                               SettingsStore
+//------------------------------------------------------------------------------
+
+class SettingsFlushTask : public QRunnable
+{
+public:
+    SettingsFlushTask(SettingsStore* store) : _store(store) {}
+    void run() override { _store->writeChanges(); }
+private:
+    SettingsStore* _store;
+};
+
+namespace {
+
+QHash<QString, QVariant> readAllValues(QString* fileName)
+{
+    QSettingsPtr s(Settings::open());
+    QHash<QString, QVariant> values;
+    for (const QString& key : s->allKeys())
+        values.insert(key, s->value(key));
+    *fileName = s->fileName();
+    return values;
+}
+
+void flushSettingsStore()
+{
+    auto store = SettingsStore::instance();
+    store->flush();
+    store->writeSnapshot();
+}
+
+bool __snapshotEnabled = false;
+
+const quint32 __snapshotMagic = 0x4F525353; // ORSS
+const quint32 __snapshotVersion = 1;
+
+} // namespace
+
+void SettingsStore::setSnapshotEnabled(bool on)
+{
+    __snapshotEnabled = on;
+}
+
+bool SettingsStore::snapshotEnabled()
+{
+    return __snapshotEnabled;
+}
+
+QString SettingsStore::snapshotPath()
+{
+    // Portable version keeps everything nearby the application,
+    // otherwise the snapshot is a cache and the location of user's ini-file
+    // is platform dependent and can't be known without opening QSettings
+    QString localIni = Settings::localIniPath();
+    if (QFileInfo(localIni).exists())
+        return localIni % ".snapshot";
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % "/settings.snapshot";
+}
+
+SettingsStore* SettingsStore::instance()
+{
+    static SettingsStore* store = new SettingsStore;
+    return store;
+}
+
+SettingsStore::SettingsStore() : QObject()
+{
+    if (__snapshotEnabled && readSnapshot())
+        _complete = false;
+    else
+        _values = readAllValues(&_fileName);
+    rememberFileStamp();
+
+    _flushTimer = new QTimer(this);
+    _flushTimer->setSingleShot(true);
+    _flushTimer->setInterval(1000);
+    connect(_flushTimer, SIGNAL(timeout()), this, SLOT(flushInBackground()));
+
+    // A single write can be reported by the watcher several times
+    _reloadTimer = new QTimer(this);
+    _reloadTimer->setSingleShot(true);
+    _reloadTimer->setInterval(200);
+    connect(_reloadTimer, SIGNAL(timeout()), this, SLOT(reloadChanged()));
+
+    // The timer should work even when the store is first accessed from a worker thread
+    if (qApp) moveToThread(qApp->thread());
+
+    qAddPostRoutine(flushSettingsStore);
+
+    // Everything read before the event loop starts is considered as startup values
+    if (__snapshotEnabled)
+    {
+        _recording.store(1);
+        QMetaObject::invokeMethod(this, "finishStartup", Qt::QueuedConnection);
+    }
+}
+
+void SettingsStore::finishStartup()
+{
+    _recording.store(0);
+}
+
+QVariant SettingsStore::value(const QString& key, const QVariant& def) const
+{
+    if (_recording.load())
+    {
+        QMutexLocker locker(&_recordLock);
+        _startupKeys.insert(key);
+    }
+    {
+        QReadLocker locker(&_lock);
+        auto it = _values.constFind(key);
+        if (it != _values.constEnd()) return it.value();
+        if (_complete || _absent.contains(key)) return def;
+    }
+    loadAll();
+    QReadLocker locker(&_lock);
+    return _values.value(key, def);
+}
+
+bool SettingsStore::contains(const QString& key) const
+{
+    {
+        QReadLocker locker(&_lock);
+        if (_values.contains(key)) return true;
+        if (_complete || _absent.contains(key)) return false;
+    }
+    loadAll();
+    QReadLocker locker(&_lock);
+    return _values.contains(key);
+}
+
+void SettingsStore::setValue(const QString& key, const QVariant& value)
+{
+    QWriteLocker locker(&_lock);
+    int slot = _slots.value(key, -1);
+    if (slot >= 0)
+    {
+        _slotValues[slot] = value;
+        _slotCached[slot] = true;
+    }
+    writeValue(key, value);
+}
+
+void SettingsStore::writeValue(const QString& key, const QVariant& value)
+{
+    auto it = _values.find(key);
+    if (it != _values.end() && it.value() == value) return;
+    _values[key] = value;
+    _changes[key] = value;
+    if (!_flushScheduled)
+    {
+        _flushScheduled = true;
+        QMetaObject::invokeMethod(_flushTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+int SettingsStore::slot(const QString& key)
+{
+    QWriteLocker locker(&_lock);
+    auto it = _slots.constFind(key);
+    if (it != _slots.constEnd()) return it.value();
+
+    int slot = _slotKeys.size();
+    _slots.insert(key, slot);
+    _slotKeys.append(key);
+    _slotValues.append(QVariant());
+    _slotCached.append(false);
+    return slot;
+}
+
+QVariant SettingsStore::slotValue(int slot) const
+{
+    QString key;
+    {
+        QReadLocker locker(&_lock);
+        if (_slotCached.at(slot))
+            return _slotValues.at(slot);
+        key = _slotKeys.at(slot);
+    }
+    QVariant v = value(key);
+    QWriteLocker locker(&_lock);
+    // The value could be set while the lock was released
+    if (!_slotCached.at(slot))
+    {
+        _slotValues[slot] = v;
+        _slotCached[slot] = true;
+    }
+    return _slotValues.at(slot);
+}
+
+void SettingsStore::setSlotValue(int slot, const QVariant& value)
+{
+    QWriteLocker locker(&_lock);
+    _slotValues[slot] = value;
+    _slotCached[slot] = true;
+    writeValue(_slotKeys.at(slot), value);
+}
+
+int SettingsStore::flushDelay() const
+{
+    return _flushTimer->interval();
+}
+
+void SettingsStore::setFlushDelay(int ms)
+{
+    _flushTimer->setInterval(ms);
+}
+
+void SettingsStore::flushInBackground()
+{
+    QThreadPool::globalInstance()->start(new SettingsFlushTask(this));
+}
+
+void SettingsStore::flush()
+{
+    writeChanges();
+}
+
+void SettingsStore::writeChanges()
+{
+    // Only one flush can write the file at a time
+    QMutexLocker flushLocker(&_flushLock);
+
+    QHash<QString, QVariant> changes;
+    {
+        QWriteLocker locker(&_lock);
+        changes.swap(_changes);
+        _flushScheduled = false;
+    }
+    if (changes.isEmpty()) return;
+
+    QSettingsPtr s(Settings::open());
+    for (auto it = changes.constBegin(); it != changes.constEnd(); it++)
+        s->setValue(it.key(), it.value());
+    s->sync();
+    _fileName = s->fileName();
+    rememberFileStamp();
+}
+
+void SettingsStore::loadAll() const
+{
+    // Don't let a background flush write the file while it's being read
+    QMutexLocker flushLocker(&_flushLock);
+    QWriteLocker locker(&_lock);
+    if (_complete) return;
+
+    auto values = readAllValues(&_fileName);
+    rememberFileStamp();
+    // Values changed since the last flush are not in the file yet
+    for (auto it = _changes.constBegin(); it != _changes.constEnd(); it++)
+        values[it.key()] = it.value();
+    _values = values;
+    _absent.clear();
+    _complete = true;
+    _slotCached.fill(false);
+}
+
+void SettingsStore::reload()
+{
+    writeChanges();
+    {
+        QWriteLocker locker(&_lock);
+        _complete = false;
+    }
+    loadAll();
+}
+
+void SettingsStore::rememberFileStamp() const
+{
+    QFileInfo file(_fileName);
+    _fileSize = file.exists() ? file.size() : -1;
+    _fileTime = file.exists() ? file.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+void SettingsStore::setWatchEnabled(bool on)
+{
+    if (on == watchEnabled()) return;
+
+    if (!on)
+    {
+        delete _watcher;
+        _watcher = nullptr;
+        return;
+    }
+
+    // Changes can't be found without knowing all the values
+    loadAll();
+
+    _watcher = new QFileSystemWatcher(this);
+    // The directory is watched too, because the file can be replaced
+    // instead of being rewritten, or it may not exist yet
+    _watcher->addPath(QFileInfo(_fileName).absolutePath());
+    if (QFileInfo(_fileName).exists())
+        _watcher->addPath(_fileName);
+    connect(_watcher, SIGNAL(fileChanged(QString)), _reloadTimer, SLOT(start()));
+    connect(_watcher, SIGNAL(directoryChanged(QString)), _reloadTimer, SLOT(start()));
+}
+
+void SettingsStore::reloadChanged()
+{
+    if (!_watcher) return;
+
+    if (!_watcher->files().contains(_fileName) && QFileInfo(_fileName).exists())
+        _watcher->addPath(_fileName);
+
+    QHash<QString, QVariant> values;
+    {
+        QMutexLocker flushLocker(&_flushLock);
+        qint64 fileSize = _fileSize, fileTime = _fileTime;
+        rememberFileStamp();
+        // Either the file was written by this process or another file in the directory changed
+        if (fileSize == _fileSize && fileTime == _fileTime) return;
+        values = readAllValues(&_fileName);
+    }
+
+    QList<QPair<QString, QVariant>> changed;
+    {
+        QWriteLocker locker(&_lock);
+        for (auto it = values.constBegin(); it != values.constEnd(); it++)
+        {
+            // Not saved local changes are preferred
+            if (_changes.contains(it.key())) continue;
+            auto old = _values.constFind(it.key());
+            if (old != _values.constEnd() && old.value() == it.value()) continue;
+            _values[it.key()] = it.value();
+            changed << qMakePair(it.key(), it.value());
+        }
+        for (const QString& key : _values.keys())
+            if (!values.contains(key) && !_changes.contains(key))
+            {
+                _values.remove(key);
+                changed << qMakePair(key, QVariant());
+            }
+        if (!changed.isEmpty())
+            _slotCached.fill(false);
+    }
+
+    for (auto& change : changed)
+        emit valueChanged(change.first, change.second);
+}
+
+bool SettingsStore::readSnapshot()
+{
+    SettingsSnapshot snapshot;
+    if (!snapshot.read(snapshotPath())) return false;
+
+    _values = snapshot.values;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    _absent = QSet<QString>(snapshot.absent.begin(), snapshot.absent.end());
+#else
+    _absent = QSet<QString>::fromList(snapshot.absent);
+#endif
+    _fileName = snapshot.iniFile;
+    return true;
+}
+
+void SettingsStore::writeSnapshot()
+{
+    if (!__snapshotEnabled) return;
+
+    SettingsSnapshot snapshot;
+    {
+        QMutexLocker recordLocker(&_recordLock);
+        QReadLocker locker(&_lock);
+        for (const QString& key : _startupKeys)
+        {
+            auto it = _values.constFind(key);
+            if (it != _values.constEnd())
+                snapshot.values.insert(key, it.value());
+            else if (_complete || _absent.contains(key))
+                snapshot.absent << key;
+        }
+    }
+
+    if (_fileName.isEmpty())
+    {
+        QSettingsPtr s(Settings::open());
+        _fileName = s->fileName();
+    }
+    snapshot.iniFile = _fileName;
+    snapshot.write(snapshotPath());
+}
+
+//------------------------------------------------------------------------------
+//                              SettingsSnapshot
+//------------------------------------------------------------------------------
+
+bool SettingsSnapshot::read(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    uchar* data = file.map(0, file.size());
+    if (!data) return false;
+
+    // Values are deserialized into their own memory, so the file can be unmapped after that
+    QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(file.size()));
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+    if (magic != __snapshotMagic || version != __snapshotVersion) return false;
+
+    QString fileName;
+    qint64 fileSize, fileTime;
+    stream >> fileName >> fileSize >> fileTime;
+    QFileInfo ini(fileName);
+    if (!ini.exists() ||
+        ini.size() != fileSize ||
+        ini.lastModified().toMSecsSinceEpoch() != fileTime)
+        return false; // stale
+
+    QHash<QString, QVariant> values;
+    QStringList absent;
+    stream >> values >> absent;
+    if (stream.status() != QDataStream::Ok) return false;
+
+    iniFile = fileName;
+    this->values = values;
+    this->absent = absent;
+    return true;
+}
+
+bool SettingsSnapshot::write(const QString& path) const
+{
+    QFileInfo ini(iniFile);
+    if (!ini.exists()) return false;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write settings snapshot" << path << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << __snapshotMagic << __snapshotVersion;
+    stream << iniFile << qint64(ini.size()) << qint64(ini.lastModified().toMSecsSinceEpoch());
+    stream << values << absent;
+    return file.commit();
+}
+
+//------------------------------------------------------------------------------
+//                                 Settings
+//------------------------------------------------------------------------------
+
 class GroupResetAndBackup
 {
 public:
@@ -68,67 +528,148 @@ void Settings::beginGroup(QSettings *settings, const QString& name)
 
 Settings::Settings()
 {
-    _settings = open();
     beginDefaultGroup();
 }
 
 Settings::~Settings()
 {
-    delete _settings;
+    if (_settings)
+    {
+        // QSettings writes its changes when deleted, after that the store has to catch them up
+        delete _settings;
+        SettingsStore::instance()->reload();
+    }
+}
+
+QSettings* Settings::settings() const
+{
+    if (!_settings)
+    {
+        SettingsStore::instance()->flush();
+        _settings = open();
+        if (!_group.isEmpty())
+            _settings->beginGroup(_group);
+    }
+    return _settings;
+}
+
+void Settings::endGroups()
+{
+    _group.clear();
+    if (_settings) endGroups(_settings);
+}
+
+void Settings::beginGroup(const QString& name)
+{
+    _group = name;
+    if (_settings) beginGroup(_settings, name);
+}
+
+QString Settings::path(const QString& key) const
+{
+    if (_group.isEmpty()) return key;
+    return _group % "/" % key;
 }
 
 void Settings::storeWindowGeometry(QWidget* w)
 {
-    SettingsHelper::storeWindowGeometry(_settings, w, w->objectName());
+    storeWindowGeometry(w->objectName(), w);
 }
 
 void Settings::restoreWindowGeometry(QWidget* w, QSize defSize)
 {
-    SettingsHelper::restoreWindowGeometry(_settings, w, w->objectName(), defSize);
+    restoreWindowGeometry(w->objectName(), w, defSize);
+}
+
+namespace {
+
+// Geometry is kept in the same form in the store and in QSettings, the helpers
+// get functions reading and writing values of the window's group by their names
+
+template <typename Write> void writeGeometry(QWidget* w, Write write)
+{
+    write(QStringLiteral("maximized"), w->isMaximized());
+    if (!w->isMaximized())
+        write(QStringLiteral("geometry"), w->geometry());
+}
+
+template <typename Read> void readGeometry(QWidget* w, QSize defSize, Read read)
+{
+    QRect g = read(QStringLiteral("geometry")).toRect();
+    if (g.width() > 0 && g.height() > 0)
+        w->setGeometry(g);
+    else if (defSize.width() > 0 && defSize.height() > 0)
+        w->resize(defSize); // stay default position
+    if (read(QStringLiteral("maximized")).toBool())
+        w->setWindowState(w->windowState() | Qt::WindowMaximized);
+}
+
+QString windowGroup(const QString& key, QWidget* w)
+{
+    return key.isEmpty() ? w->objectName() : key;
 }
 
+} // namespace
+
 void Settings::storeWindowGeometry(const QString& key, QWidget* w)
 {
-    SettingsHelper::storeWindowGeometry(_settings, w, key);
+    if (_settings)
+    {
+        SettingsHelper::storeWindowGeometry(_settings, w, key);
+        return;
+    }
+
+    auto group = windowGroup(key, w);
+    if (group.isEmpty()) return;
+
+    auto store = SettingsStore::instance();
+    QString prefix = "WindowStates/" % group % "/";
+    writeGeometry(w, [store, &prefix](const QString& name, const QVariant& value){
+        store->setValue(prefix + name, value);
+    });
 }
 
 void Settings::restoreWindowGeometry(const QString &key, QWidget* w, QSize defSize)
 {
-    SettingsHelper::restoreWindowGeometry(_settings, w, key, defSize);
+    if (_settings)
+    {
+        SettingsHelper::restoreWindowGeometry(_settings, w, key, defSize);
+        return;
+    }
+
+    auto group = windowGroup(key, w);
+    if (group.isEmpty()) return;
+
+    auto store = SettingsStore::instance();
+    QString prefix = "WindowStates/" % group % "/";
+    readGeometry(w, defSize, [store, &prefix](const QString& name){
+        return store->value(prefix + name);
+    });
 }
 
 namespace SettingsHelper {
 void storeWindowGeometry(QSettings* s, QWidget* w, const QString& key)
 {
-    auto group = key.isEmpty() ? w->objectName() : key;
+    auto group = windowGroup(key, w);
     if (group.isEmpty()) return;
 
     GroupResetAndBackup backup(s);
 
     s->beginGroup("WindowStates");
     s->beginGroup(group);
-    s->setValue("maximized", w->isMaximized());
-    if (!w->isMaximized())
-        s->setValue("geometry", w->geometry());
-
+    writeGeometry(w, [s](const QString& name, const QVariant& value){ s->setValue(name, value); });
 }
 
 void restoreWindowGeometry(QSettings* s, QWidget* w, const QString& key, QSize defSize)
 {
-    auto group = key.isEmpty() ? w->objectName() : key;
+    auto group = windowGroup(key, w);
     if (group.isEmpty()) return;
 
     GroupResetAndBackup backup(s);
 
     s->beginGroup("WindowStates");
     s->beginGroup(group);
-    QRect g = s->value("geometry").toRect();
-    if (g.width() > 0 && g.height() > 0)
-        w->setGeometry(g);
-    else if (defSize.width() > 0 && defSize.height() > 0)
-        w->resize(defSize); // stay default position
-    if (s->value("maximized").toBool())
-        w->setWindowState(w->windowState() | Qt::WindowMaximized);
+    readGeometry(w, defSize, [s](const QString& name){ return s->value(name); });
 }
 } // namespace SettingsHelper
 
@@ -140,38 +681,55 @@ void Settings::storeDockState(const QString& key, QMainWindow* w)
 {
     if (key.isEmpty()) return;
 
-    GroupResetAndBackup backup(_settings);
+    if (_settings)
+    {
+        GroupResetAndBackup backup(_settings);
+
+        _settings->beginGroup("WindowStates");
+        _settings->beginGroup(key);
+        _settings->setValue("toolbars", w->saveState());
+        return;
+    }
 
-    _settings->beginGroup("WindowStates");
-    _settings->beginGroup(key);
-    _settings->setValue("toolbars", w->saveState());
+    SettingsStore::instance()->setValue("WindowStates/" % key % "/toolbars", w->saveState());
 }
 
 void Settings::restoreDockState(const QString& key, QMainWindow* w)
 {
     if (key.isEmpty()) return;
 
-    GroupResetAndBackup backup(_settings);
+    if (_settings)
+    {
+        GroupResetAndBackup backup(_settings);
+
+        _settings->beginGroup("WindowStates");
+        _settings->beginGroup(key);
+        w->restoreState(_settings->value("toolbars").toByteArray());
+        return;
+    }
 
-    _settings->beginGroup("WindowStates");
-    _settings->beginGroup(key);
-    w->restoreState(_settings->value("toolbars").toByteArray());
+    w->restoreState(SettingsStore::instance()->value("WindowStates/" % key % "/toolbars").toByteArray());
 }
 
 
 QString Settings::strValue(const QString& key, const QString& value)
 {
-    return _settings->value(key, value).toString();
+    return this->value(key, value).toString();
 }
 
 void Settings::setValue(const QString& key, const QVariant& value)
 {
-    _settings->setValue(key, value);
+    if (_settings)
+        _settings->setValue(key, value);
+    else
+        SettingsStore::instance()->setValue(path(key), value);
 }
 
 QVariant Settings::value(const QString& key, const QVariant& def)
 {
-    return _settings->value(key, def);
+    if (_settings)
+        return _settings->value(key, def);
+    return SettingsStore::instance()->value(path(key), def);
 }
 
 } // namespace Ori
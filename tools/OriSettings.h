@@ -1,8 +1,14 @@
 #ifndef ORI_SETTINGS_H
 #define ORI_SETTINGS_H
 
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSet>
 #include <QSettings>
 #include <QSize>
+#include <QVector>
 #include <memory>
 
 class Settings;
@@ -14,14 +20,141 @@ typedef std::auto_ptr<QSettings> QSettingsPtr;
 #endif
 
 QT_BEGIN_NAMESPACE
+class QFileSystemWatcher;
 class QMainWindow;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace Ori {
 
+/** Binary startup snapshot of settings, see SettingsStore::setSnapshotEnabled().
+    The snapshot is bound to the state of the ini-file at the moment of writing.
+*/
+struct SettingsSnapshot
+{
+    QString iniFile;
+    QHash<QString, QVariant> values;
+    QStringList absent; // keys known to be missing in the ini-file
+
+    /// Returns false when there is no valid snapshot at the path,
+    /// or when it's stale, i.e. the ini-file has been changed since the snapshot was written.
+    bool read(const QString& path);
+
+    /// Does nothing and returns false when the ini-file doesn't exist.
+    bool write(const QString& path) const;
+};
+
+/** Process-wide in-memory copy of the settings file.
+    The file is parsed once at first access and then all reads are served from memory.
+    Changed values are collected and written to the file by a single background flush
+    after a short delay. Pending changes are flushed when the application object is destroyed.
+    Keys are full paths including groups, e.g. `WindowStates/mainWindow/geometry`.
+
+    Optionally the store can use a startup snapshot: keys read before the event loop starts
+    are saved at exit in binary form into a file alongside the ini-file. At next start
+    the snapshot is mapped into memory and its values are served without parsing the ini-file.
+    The ini-file is parsed only when a key missing in the snapshot is requested.
+    The snapshot is ignored when the ini-file has been changed since the snapshot was written.
+
+    When several processes share the same ini-file, the store can watch it (see setWatchEnabled()).
+    Changes made by other processes are then read once per change, compared with the values
+    in memory, and each changed key is reported via valueChanged() signal.
+*/
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SettingsStore* instance();
+
+    /// Should be called before the first access to settings.
+    static void setSnapshotEnabled(bool on);
+    static bool snapshotEnabled();
+    static QString snapshotPath();
+
+    QVariant value(const QString& key, const QVariant& def = QVariant()) const;
+    void setValue(const QString& key, const QVariant& value);
+    bool contains(const QString& key) const;
+
+    /// Writes pending changes to the file, waits until it's done.
+    void flush();
+
+    /// Re-reads the file, e.g. after it was changed bypassing the store.
+    /// Pending changes are flushed before.
+    void reload();
+
+    /// Saves values of keys read at startup, see snapshotEnabled().
+    void writeSnapshot();
+
+    /// Delay in ms between the first unsaved change and the background flush.
+    int flushDelay() const;
+    void setFlushDelay(int ms);
+
+    /// Registers the key for access by index, returns the index.
+    /// Values of registered keys are cached in a plain array, see SettingsKey.
+    int slot(const QString& key);
+    QVariant slotValue(int slot) const;
+    void setSlotValue(int slot, const QVariant& value);
+
+    /// Starts or stops watching the ini-file for changes made by other processes.
+    /// Should be called from the main thread.
+    void setWatchEnabled(bool on);
+    bool watchEnabled() const { return _watcher; }
+
+signals:
+    /// Emitted for each key changed by another process.
+    /// Value is invalid if the key has been removed.
+    void valueChanged(const QString& key, const QVariant& value);
+
+private:
+    SettingsStore();
+
+    mutable QReadWriteLock _lock;
+    mutable QHash<QString, QVariant> _values;
+    QHash<QString, QVariant> _changes;
+    bool _flushScheduled = false;
+    mutable QMutex _flushLock;
+    QTimer* _flushTimer;
+
+    // Startup snapshot
+    mutable bool _complete = true; // the whole ini-file is loaded
+    mutable QSet<QString> _absent; // keys known to be missing in the ini-file
+    mutable QString _fileName;
+    QAtomicInt _recording;
+    mutable QMutex _recordLock;
+    mutable QSet<QString> _startupKeys;
+
+    // Slots
+    QHash<QString, int> _slots;
+    QVector<QString> _slotKeys;
+    mutable QVector<QVariant> _slotValues;
+    mutable QVector<bool> _slotCached;
+
+    // Watching
+    QFileSystemWatcher* _watcher = nullptr;
+    QTimer* _reloadTimer;
+    mutable qint64 _fileSize = -1;
+    mutable qint64 _fileTime = -1;
+
+    void writeValue(const QString& key, const QVariant& value);
+    void writeChanges();
+    void loadAll() const;
+    bool readSnapshot();
+    void rememberFileStamp() const;
+
+    friend class SettingsFlushTask;
+
+private slots:
+    void flushInBackground();
+    void finishStartup();
+    void reloadChanged();
+};
+
 /** Thin wrapper around QSettings.
     By default configures QSettings to use ini-files instead of Windows registry.
     Can look for local ini-file nearby an applicaion allowing program be 'portable'.
+    Values are read and written through the shared SettingsStore,
+    so creating an object of this class doesn't touch the settings file.
 */
 class Settings
 {
@@ -42,7 +175,11 @@ public:
     Settings();
     ~Settings();
 
-    QSettings* settings() const { return _settings; }
+    /// Direct access to the settings file. When it's requested, the object
+    /// switches to reading and writing values through the returned QSettings.
+    /// Pending changes of the store are flushed before, and the store is reloaded
+    /// when the object is destroyed, so use it only when QSettings API is really needed.
+    QSettings* settings() const;
 
     void storeWindowGeometry(QWidget*);
     void restoreWindowGeometry(QWidget*, QSize defSize = QSize());
@@ -54,9 +191,10 @@ public:
     void storeDockState(const QString& key, QMainWindow*);
     void restoreDockState(const QString& key, QMainWindow*);
 
-    void endGroups() { endGroups(_settings); }
-    void beginGroup(const QString& name) { beginGroup(_settings, name); }
-    void beginDefaultGroup() { beginGroup(_settings, "Common"); }
+    const QString& group() const { return _group; }
+    void endGroups();
+    void beginGroup(const QString& name);
+    void beginDefaultGroup() { beginGroup("Common"); }
     void resetGroup() { endGroups(); beginDefaultGroup(); }
 
     QString strValue(const QString& key, const QString& value = QString());
@@ -84,7 +222,10 @@ public:
     static void restoreDocks(QMainWindow* w) { Settings().storeDockState(w); }
 
 private:
-    QSettings* _settings;
+    mutable QSettings* _settings = nullptr;
+    QString _group;
+
+    QString path(const QString& key) const;
 };
 
 namespace SettingsHelper {
@@ -0,0 +1,79 @@
+#ifndef ORI_SETTINGS_SCHEMA_H
+#define ORI_SETTINGS_SCHEMA_H
+
+#include "OriSettings.h"
+
+#include <QAtomicInt>
+
+namespace Ori {
+
+/** Typed settings key with a default value.
+    The full path of the key (including groups, e.g. `View/showToolbar`)
+    is registered in SettingsStore once at first access, after that values are read
+    and written by slot index without any string processing or group navigation.
+    Keys are supposed to be declared with ORI_SETTING macro:
+
+        struct AppSettings
+        {
+            ORI_SETTING(bool, showToolbar, "View/showToolbar", true)
+            ORI_SETTING(int, recentCount, "Common/recentCount", 10)
+        };
+
+        if (AppSettings::showToolbar().value()) ...
+        AppSettings::recentCount().setValue(20);
+*/
+template <typename T> class SettingsKey
+{
+public:
+    SettingsKey(const QString& path, const T& def = T()) : _path(path), _default(def) {}
+
+    const QString& path() const { return _path; }
+    const T& defaultValue() const { return _default; }
+
+    /// Returns the default value when the key is absent
+    /// or its stored value can't be converted to the type of the key.
+    T value() const
+    {
+        QVariant v = SettingsStore::instance()->slotValue(slot());
+        if (!v.isValid()) return _default;
+        if (v.userType() == qMetaTypeId<T>()) return v.template value<T>();
+        return v.convert(qMetaTypeId<T>()) ? v.template value<T>() : _default;
+    }
+
+    void setValue(const T& value) const
+    {
+        SettingsStore::instance()->setSlotValue(slot(), QVariant::fromValue(value));
+    }
+
+    void reset() const { setValue(_default); }
+
+private:
+    QString _path;
+    T _default;
+    mutable QAtomicInt _slot { -1 };
+
+    int slot() const
+    {
+        int slot = _slot.load();
+        if (slot < 0)
+        {
+            // Registering is idempotent, so concurrent first calls get the same slot
+            slot = SettingsStore::instance()->slot(_path);
+            _slot.store(slot);
+        }
+        return slot;
+    }
+};
+
+} // namespace Ori
+
+/// Declares a static function returning a typed settings key.
+/// The key object is created at the first call of the function.
+#define ORI_SETTING(type, name, path, def)                                       \
+    static const Ori::SettingsKey<type>& name()                                  \
+    {                                                                            \
+        static Ori::SettingsKey<type> key(QStringLiteral(path), def);            \
+        return key;                                                              \
+    }
+
+#endif // ORI_SETTINGS_SCHEMA_H
@@ -1,8 +1,11 @@
 #include "OriStyler.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QStyle>
 #include <QStyleFactory>
+#include <QTimer>
+#include <QWidget>
 
 namespace Ori {
 
@@ -24,12 +27,170 @@ QStringList Styler::getStyles() const
 
 QString Styler::currentStyle() const
 {
+    if (_style)
+        return _style->objectName();
     return qApp->style()->objectName();
 }
 
 void Styler::setCurrentStyle(const QString& style)
 {
-    qApp->setStyle(style);
+    setCurrentStyle(style, Immediate);
+}
+
+void Styler::setCurrentStyle(const QString& style, SwitchMode mode)
+{
+    QStyle* newStyle = QStyleFactory::create(style);
+    if (!newStyle) return;
+
+    // Until windows are shown, there is nothing to repolish
+    if (mode == Staged)
+    {
+        bool hasVisible = false;
+        for (QWidget* w : QApplication::topLevelWidgets())
+            if (w->isVisible())
+            {
+                hasVisible = true;
+                break;
+            }
+        if (!hasVisible) mode = Immediate;
+    }
+
+    if (mode == Immediate)
+    {
+        resetStaged(newStyle);
+        emit styleSwitched();
+        return;
+    }
+
+    // The application style is deleted by QApplication when the new one replaces it.
+    // A style of interrupted switching is not the application one yet,
+    // and it's still used by some widgets until they get the new style.
+    newStyle->setParent(qApp);
+    if (_style && _timer)
+        connect(this, SIGNAL(styleSwitched()), _style, SLOT(deleteLater()), Qt::UniqueConnection);
+    _style = newStyle;
+    _pending.clear();
+    _pendingSet.clear();
+
+    for (QWidget* w : QApplication::allWidgets())
+    {
+        if (w->windowType() == Qt::Desktop) continue;
+        // Widgets having their own styles are not touched
+        if (w->testAttribute(Qt::WA_SetStyle) && !_styled.contains(w)) continue;
+        if (w->isVisible())
+            setWidgetStyle(w);
+        else
+        {
+            _pending.append(w);
+            _pendingSet.insert(w);
+        }
+    }
+
+    if (!_timer)
+    {
+        _timer = new QTimer(this);
+        _timer->setSingleShot(true);
+        _timer->setInterval(0);
+        connect(_timer, SIGNAL(timeout()), this, SLOT(styleHiddenWidgets()));
+        qApp->installEventFilter(this);
+    }
+    _timer->start();
+}
+
+void Styler::setWidgetStyle(QWidget* w)
+{
+    w->setStyle(_style);
+    _styled.insert(w);
+}
+
+void Styler::styleHiddenWidgets()
+{
+    // Slices are short enough to keep the application responsive
+    QElapsedTimer timer;
+    timer.start();
+    while (!_pending.isEmpty() && timer.elapsed() < 10)
+    {
+        QPointer<QWidget> w = _pending.takeFirst();
+        if (w && _pendingSet.remove(w))
+            setWidgetStyle(w);
+    }
+    if (!_pending.isEmpty())
+    {
+        _timer->start();
+        return;
+    }
+    finishStaged();
+    emit styleSwitched();
+}
+
+void Styler::finishStaged()
+{
+    _pendingSet.clear();
+    qApp->removeEventFilter(this);
+    delete _timer;
+    _timer = nullptr;
+
+    // Forget widgets deleted since they were styled
+    QSet<QWidget*> alive;
+    for (QWidget* w : QApplication::allWidgets())
+        if (_styled.contains(w))
+            alive.insert(w);
+    _styled = alive;
+
+    // Styled widgets have their own style now, so QApplication only calls polish() for them
+    // but doesn't send StyleChange, which is what makes them relayout. New widgets get
+    // the application style since now. Palette is the last thing to be switched.
+    qApp->setStyle(_style);
+}
+
+bool Styler::eventFilter(QObject* obj, QEvent* event)
+{
+    if (_style && obj->isWidgetType())
+    {
+        auto w = static_cast<QWidget*>(obj);
+        if (event->type() == QEvent::Create)
+        {
+            // The event is sent from the QWidget constructor, so new widgets
+            // get the style before their first polish and it costs nothing
+            if (w->windowType() != Qt::Desktop)
+                setWidgetStyle(w);
+        }
+        else if (event->type() == QEvent::Show)
+        {
+            if (_pendingSet.remove(w))
+                setWidgetStyle(w);
+        }
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void Styler::resetStaged(QStyle* newStyle)
+{
+    if (_timer)
+    {
+        _timer->stop();
+        qApp->removeEventFilter(this);
+        delete _timer;
+        _timer = nullptr;
+    }
+    _pending.clear();
+    _pendingSet.clear();
+
+    // The staged style is kept alive until its widgets return to the application style,
+    // otherwise QApplication could delete it while it's still in use
+    QStyle* stagedStyle = _style;
+    _style = nullptr;
+    if (stagedStyle)
+        stagedStyle->setParent(this);
+
+    qApp->setStyle(newStyle);
+
+    for (QWidget* w : QApplication::allWidgets())
+        if (_styled.contains(w) && w->testAttribute(Qt::WA_SetStyle))
+            w->setStyle(nullptr);
+    _styled.clear();
+
+    delete stagedStyle;
 }
 
 } // namespace Ori
@@ -2,6 +2,13 @@
 #define ORI_STYLER_H
 
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+
+QT_BEGIN_NAMESPACE
+class QStyle;
+class QTimer;
+QT_END_NAMESPACE
 
 namespace Ori {
 
@@ -10,13 +17,43 @@ class Styler : public QObject
     Q_OBJECT
 
 public:
+    /// Immediate mode sets the style to the application, it repolishes all widgets at once.
+    /// Staged mode sets the style to visible widgets immediately and to hidden widgets
+    /// in small portions when the application is idle; hidden widgets being shown
+    /// and new widgets get the style at once. When all widgets are styled, the style
+    /// is set to the application, along with its standard palette. It doesn't relayout
+    /// widgets again, as they already have the style. Widgets having their own styles are left as is.
+    enum SwitchMode { Immediate, Staged };
+
     Styler(QObject* parent = 0);
     Styler(const QString& style, QObject* parent = 0);
 
     QString currentStyle() const;
     void setCurrentStyle(const QString& style);
+    void setCurrentStyle(const QString& style, SwitchMode mode);
 
     QStringList getStyles() const;
+
+signals:
+    /// Emitted when all existing widgets have got the new style.
+    void styleSwitched();
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* event) override;
+
+private:
+    QPointer<QStyle> _style;
+    QSet<QWidget*> _styled;
+    QList<QPointer<QWidget>> _pending;
+    QSet<QWidget*> _pendingSet;
+    QTimer* _timer = nullptr;
+
+    void setWidgetStyle(QWidget* w);
+    void finishStaged();
+    void resetStaged(QStyle* newStyle);
+
+private slots:
+    void styleHiddenWidgets();
 };
 
 } // namespace Ori
@@ -1,9 +1,18 @@
 #include "OriTranslator.h"
 
 #include <QApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
 #include <QDir>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
 #include <QTranslator>
 
+#include <memory>
+
 #if (QT_VERSION < QT_VERSION_CHECK(5, 0, 0))
     #define QStringLiteral QString::fromLatin1
 #endif
@@ -29,6 +38,77 @@ bool TranslatorSetup::isDefault(const QString& lang) const
     return lang == defaultLang;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//                             TranslationFiles
+////////////////////////////////////////////////////////////////////////////////
+
+class TranslationPreloadTask : public QRunnable
+{
+public:
+    TranslationPreloadTask(const QStringList& paths) : _paths(paths) {}
+
+    void run() override
+    {
+        auto files = TranslationFiles::instance();
+        for (const QString& path : _paths)
+        {
+            QByteArray data = files->data(path);
+            // Reading a byte of each page makes the system load the page
+            volatile char sum = 0;
+            for (int i = 0; i < data.size(); i += 4096)
+                sum += data.at(i);
+        }
+        emit files->preloaded(_paths);
+    }
+
+private:
+    QStringList _paths;
+};
+
+TranslationFiles* TranslationFiles::instance()
+{
+    static TranslationFiles files;
+    return &files;
+}
+
+QByteArray TranslationFiles::data(const QString& path)
+{
+    QMutexLocker locker(&_lock);
+
+    auto it = _data.constFind(path);
+    if (it != _data.constEnd())
+        return it.value();
+
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QByteArray data;
+    uchar* mem = file->map(0, file->size());
+    if (mem)
+    {
+        // Maps live as long as the application, so the data can refer to them directly
+        data = QByteArray::fromRawData(reinterpret_cast<const char*>(mem), int(file->size()));
+        _files.insert(path, file.release());
+    }
+    else
+        data = file->readAll();
+    _data.insert(path, data);
+    return data;
+}
+
+bool TranslationFiles::isMapped(const QString& path) const
+{
+    QMutexLocker locker(&_lock);
+    return _data.contains(path);
+}
+
+void TranslationFiles::preload(const QStringList& paths)
+{
+    if (!paths.isEmpty())
+        QThreadPool::globalInstance()->start(new TranslationPreloadTask(paths));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                              Translator
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,6 +123,7 @@ TranslatorSetup Translator::defaultSetup()
     setup.defaultLang = QStringLiteral("en");
     setup.defaultLangName = QStringLiteral("English");
     setup.applyImmediately = false;
+    setup.applyInBackground = false;
     return setup;
 }
 
@@ -61,6 +142,8 @@ Translator::Translator(TranslatorSetup setup, QObject *parent) : QObject(parent)
 {
     _setup = setup;
     _currentLang = _setup.defaultLang;
+
+    connect(TranslationFiles::instance(), SIGNAL(preloaded(QStringList)), this, SLOT(filesPreloaded(QStringList)));
 }
 
 Translator::Translator(const QString& lang, QObject *parent) : Translator(lang, defaultSetup(), parent)
@@ -80,8 +163,55 @@ void Translator::setCurrentLanguage(const QString& lang)
 
     _currentLang = lang;
 
-    if (_setup.applyImmediately)
+    if (!_setup.applyImmediately) return;
+
+    // Files are read in background and the language is applied when they are ready
+    if (_setup.applyInBackground && !_setup.isDefault(lang) && !isLanguageReady(lang))
+    {
+        _pendingLang = lang;
+        preload(QStringList(lang));
+        return;
+    }
+    _pendingLang.clear();
+    applyLanguage();
+}
+
+bool Translator::isLanguageReady(const QString& lang) const
+{
+    // There is nothing to wait for when a file is absent (e.g. when there is no `qt_xx.qm`)
+    auto files = TranslationFiles::instance();
+    for (const QString& path : { langFilePath(lang), qtLangFilePath(lang) })
+        if (!files->isMapped(path) && QFileInfo::exists(path))
+            return false;
+    return true;
+}
+
+void Translator::preload(const QStringList& langs)
+{
+    QStringList paths;
+    for (const QString& lang : langs)
+        if (!_setup.isDefault(lang))
+            paths << langFilePath(lang) << qtLangFilePath(lang);
+    TranslationFiles::instance()->preload(paths);
+}
+
+void Translator::filesPreloaded(const QStringList& paths)
+{
+    if (_pendingLang.isEmpty() || !paths.contains(langFilePath(_pendingLang))) return;
+
+    if (_pendingLang == _currentLang)
         applyLanguage();
+    _pendingLang.clear();
+}
+
+QString Translator::langFilePath(const QString& lang) const
+{
+    return QDir(_setup.languagesDir).filePath(_setup.langFileName(lang));
+}
+
+QString Translator::qtLangFilePath(const QString& lang) const
+{
+    return QDir(_setup.languagesDir).filePath(_setup.qtLangFileName(lang));
 }
 
 void Translator::applyLanguage()
@@ -116,8 +246,19 @@ void Translator::setTranslator(const QString& lang)
     if (!_translatorQt)
         qApp->installTranslator(_translatorQt = new QTranslator(qApp));
 
-    _translator->load(_setup.langFileName(lang), _setup.languagesDir);
-    _translatorQt->load(_setup.qtLangFileName(lang), _setup.languagesDir);
+    loadTranslator(_translator, _setup.langFileName(lang));
+    loadTranslator(_translatorQt, _setup.qtLangFileName(lang));
+}
+
+void Translator::loadTranslator(QTranslator* translator, const QString& fileName)
+{
+    // Translators use the mapped data directly without copying it
+    QByteArray data = TranslationFiles::instance()->data(QDir(_setup.languagesDir).filePath(fileName));
+    if (!data.isEmpty())
+        translator->load(reinterpret_cast<const uchar*>(data.constData()), data.size(), _setup.languagesDir);
+    else
+        // Translator can find a file of more general locale, e.g. `app_pt` for `app_pt_BR`
+        translator->load(fileName, _setup.languagesDir);
 }
 
 QStringList Translator::getLanguages() const
@@ -141,12 +282,94 @@ QString Translator::getLanguageName(const QString& lang) const
     if (_setup.isDefault(lang))
         return _setup.defaultLangName;
 
+    loadLanguageIndex();
+
+    QFileInfo file(langFilePath(lang));
+    qint64 fileSize = file.size();
+    qint64 fileTime = file.lastModified().toMSecsSinceEpoch();
+    auto it = _langIndex.constFind(lang);
+    if (it != _langIndex.constEnd() && it->fileSize == fileSize && it->fileTime == fileTime)
+        return it->name;
+
     QTranslator tr; tr.load(_setup.langFileName(lang), _setup.languagesDir);
 
     QString langName = tr.translate("Language", "English", "Translate this to the "
         "language of the translation file, NOT to the meaning of 'English'!");
+    if (langName.isEmpty()) langName = lang;
+
+    _langIndex[lang] = { langName, fileSize, fileTime };
+    if (!_langIndexChanged)
+    {
+        // Names are usually requested for all languages at once, they are saved together
+        _langIndexChanged = true;
+        QMetaObject::invokeMethod(const_cast<Translator*>(this), "saveLanguageIndex", Qt::QueuedConnection);
+    }
+    return langName;
+}
+
+namespace {
+
+const quint32 __langIndexMagic = 0x4F524C49;
+const quint32 __langIndexVersion = 1;
+
+QString languageIndexPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % QStringLiteral("/languages.index");
+}
+
+} // namespace
+
+void Translator::loadLanguageIndex() const
+{
+    if (_langIndexLoaded) return;
+    _langIndexLoaded = true;
+
+    QFile file(languageIndexPath());
+    if (!file.open(QIODevice::ReadOnly)) return;
 
-    return langName.isEmpty()? lang: langName;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    QString dir, prefix;
+    stream >> magic >> version;
+    if (magic != __langIndexMagic || version != __langIndexVersion) return;
+    stream >> dir >> prefix;
+    // The index belongs to another set of translations
+    if (dir != _setup.languagesDir || prefix != _setup.langFilePrefix) return;
+
+    quint32 count;
+    stream >> count;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString lang;
+        LanguageInfo info;
+        stream >> lang >> info.name >> info.fileSize >> info.fileTime;
+        if (stream.status() == QDataStream::Ok)
+            _langIndex.insert(lang, info);
+    }
+}
+
+void Translator::saveLanguageIndex()
+{
+    if (!_langIndexChanged) return;
+    _langIndexChanged = false;
+
+    QString path = languageIndexPath();
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Unable to write language index" << path << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << __langIndexMagic << __langIndexVersion
+           << _setup.languagesDir << _setup.langFilePrefix << quint32(_langIndex.size());
+    for (auto it = _langIndex.constBegin(); it != _langIndex.constEnd(); it++)
+        stream << it.key() << it->name << it->fileSize << it->fileTime;
+    if (!file.commit())
+        qWarning() << "Unable to write language index" << path << file.errorString();
 }
 
 } // namespace Ori
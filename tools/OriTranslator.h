@@ -1,9 +1,13 @@
 #ifndef ORI_TRANSLATOR_H
 #define ORI_TRANSLATOR_H
 
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
 
 QT_BEGIN_NAMESPACE
+class QFile;
 class QTranslator;
 QT_END_NAMESPACE
 
@@ -19,7 +23,12 @@ public:
     QString langFileSuffix;
     QString defaultLang;
     QString defaultLangName;
-    bool applyImmediately;
+    bool applyImmediately = false;
+
+    /// When files of a language are not preloaded yet, they are read in background
+    /// and the language is applied later instead of blocking in setCurrentLanguage().
+    /// It's only used when `applyImmediately` is set.
+    bool applyInBackground = false;
 
     QString langFileName(const QString& lang) const;
     QString qtLangFileName(const QString& lang) const;
@@ -28,6 +37,41 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/** Translation files mapped into memory, shared by all translators of the process.
+    Files are mapped read-only, so the same files opened by several instances
+    of the application share physical memory pages.
+*/
+class TranslationFiles : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TranslationFiles* instance();
+
+    /// Returns content of the file, the file is mapped at first call.
+    /// Returns an empty array if there is no such file. It's thread-safe.
+    QByteArray data(const QString& path);
+
+    bool isMapped(const QString& path) const;
+
+    /// Maps files in background and reads their pages in, so later
+    /// loading of translations from them doesn't touch the disk.
+    void preload(const QStringList& paths);
+
+signals:
+    /// Emitted from a worker thread when the files requested by preload() are ready.
+    void preloaded(const QStringList& paths);
+
+private:
+    TranslationFiles() {}
+
+    mutable QMutex _lock;
+    QHash<QString, QFile*> _files;
+    QHash<QString, QByteArray> _data;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class Translator : public QObject
 {
     Q_OBJECT
@@ -46,6 +90,10 @@ public:
 
     bool isApplyImmediately() const { return _setup.applyImmediately; }
 
+    /// Loads translation files of the languages in background, e.g. of the next likely language.
+    /// When a preloaded language is applied, translations are installed without reading files.
+    void preload(const QStringList& langs);
+
     static TranslatorSetup defaultSetup();
     static TranslatorSetup immediateSetup();
 
@@ -54,10 +102,32 @@ private:
     TranslatorSetup _setup;
     QTranslator* _translator = nullptr;
     QTranslator* _translatorQt = nullptr;
+    QString _pendingLang;
+
+    // Names of languages are cached to not load translation files for getting them,
+    // a cached name is valid while its translation file is not changed
+    struct LanguageInfo
+    {
+        QString name;
+        qint64 fileSize;
+        qint64 fileTime;
+    };
+    mutable QMap<QString, LanguageInfo> _langIndex;
+    mutable bool _langIndexLoaded = false;
+    mutable bool _langIndexChanged = false;
 
     void applyLanguage();
     void resetTranslator();
     void setTranslator(const QString& lang);
+    void loadTranslator(QTranslator* translator, const QString& fileName);
+    bool isLanguageReady(const QString& lang) const;
+    QString langFilePath(const QString& lang) const;
+    QString qtLangFilePath(const QString& lang) const;
+    void loadLanguageIndex() const;
+
+private slots:
+    void saveLanguageIndex();
+    void filesPreloaded(const QStringList& paths);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "PaletteModel.h"
 #include "helpers/OriLayouts.h"
 #include "helpers/OriTools.h"
 #include "helpers/OriWindows.h"
@@ -25,8 +26,8 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent)
     rndParamsLayout->addRow(new QLabel("Lighten Than"), lightenThan);
     rndParamsLayout->addRow(new QLabel("Min distance"), minDistance);
 
-    colCount = Ori::Gui::spinBox(1, 100, 10);
-    rowCount = Ori::Gui::spinBox(1, 100, 10);
+    colCount = Ori::Gui::spinBox(1, 1000, 10);
+    rowCount = Ori::Gui::spinBox(1, 1000, 10);
     auto countLayout = new QFormLayout;
     countLayout->addRow(new QLabel("Cols"), colCount);
     countLayout->addRow(new QLabel("Rwos"), rowCount);
@@ -34,12 +35,18 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent)
     auto buttonGenerate = new QPushButton("Generate");
     connect(buttonGenerate, &QPushButton::clicked, this, &MainWindow::generate);
 
-    palette = new QTableWidget;
-    palette->verticalHeader()->hide();
-    palette->horizontalHeader()->hide();
-    palette->setRowCount(rowCount->value());
-    palette->setColumnCount(colCount->value());
-    adjustCellSizes();
+    // Fixed section sizes let the view skip measuring of each row and column
+    paletteModel = new PaletteModel(this);
+    palette = new QTableView;
+    palette->setModel(paletteModel);
+    palette->setItemDelegate(new PaletteDelegate(palette));
+    for (auto header : {palette->verticalHeader(), palette->horizontalHeader()})
+    {
+        header->hide();
+        header->setMinimumSectionSize(4);
+        header->setDefaultSectionSize(24);
+        header->setSectionResizeMode(QHeaderView::Fixed);
+    }
 
     LayoutH({
                 LayoutV({
@@ -64,45 +71,23 @@ MainWindow::MainWindow(QWidget *parent) : QWidget(parent)
     Ori::Wnd::moveToScreenCenter(this);
 }
 
-void MainWindow::adjustCellSizes()
-{
-    for (int r = 0; r < palette->rowCount(); r++)
-        palette->setRowHeight(r, 24);
-    for (int c = 0; c < palette->columnCount(); c++)
-        palette->setColumnWidth(c, 24);
-}
-
 void MainWindow::generate()
 {
     int rows = rowCount->value();
     int cols = colCount->value();
 
-    palette->setRowCount(rows);
-    palette->setColumnCount(cols);
-    adjustCellSizes();
-
-    bool simple = simpleRnd->isChecked();
-    int darken = darkenThan->value();
-    int lighten = lightenThan->value();
-    int distance = minDistance->value();
-
-    for (int r = 0; r < rows; r++)
-        for (int c = 0; c < cols; c++)
-        {
-            auto item = palette->item(r, c);
-            if (!item)
-            {
-                item = new QTableWidgetItem;
-                palette->setItem(r, c, item);
-            }
-            auto color = simple
-                    ? Ori::Color::random()
-                    : Ori::Color::random(darken, lighten, distance);
-            item->setBackgroundColor(color);
-            item->setToolTip(QString("%1\n%2\n%3")
-                             .arg(Ori::Color::formatHtml(color))
-                             .arg(Ori::Color::formatRgb(color))
-                             .arg(Ori::Color::formatHsl(color))
-                             );
-        }
+    if (simpleRnd->isChecked())
+        paletteModel->generate(rows, cols, [](Ori::Random& rnd, QColor&){
+            return Ori::Color::random(rnd).rgb();
+        });
+    else
+    {
+        int darken = darkenThan->value();
+        int lighten = lightenThan->value();
+        int distance = minDistance->value();
+        // Each block keeps its own previous color for the distance check
+        paletteModel->generate(rows, cols, [darken, lighten, distance](Ori::Random& rnd, QColor& previous){
+            return Ori::Color::random(rnd, darken, lighten, distance, previous).rgb();
+        });
+    }
 }
@@ -3,7 +3,9 @@
 
 #include <QSpinBox>
 #include <QRadioButton>
-#include <QTableWidget>
+#include <QTableView>
+
+class PaletteModel;
 
 class MainWindow : public QWidget
 {
@@ -16,9 +18,9 @@ private:
     QRadioButton *simpleRnd, *paramsRnd;
     QSpinBox *darkenThan, *lightenThan, *minDistance;
     QSpinBox *colCount, *rowCount;
-    QTableWidget *palette;
+    QTableView *palette;
+    PaletteModel *paletteModel;
 
-    void adjustCellSizes();
     void generate();
 };
 
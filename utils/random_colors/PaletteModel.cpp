@@ -0,0 +1,95 @@
+#include "PaletteModel.h"
+#include "core/OriRandom.h"
+#include "helpers/OriTools.h"
+
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace {
+
+class GenerateTask : public QRunnable
+{
+public:
+    GenerateTask(QRgb* colors, int count, quint64 seed, quint64 block, const PaletteModel::ColorMaker& makeColor)
+        : _colors(colors), _count(count), _rnd(seed, block), _makeColor(makeColor) {}
+
+    void run() override
+    {
+        for (int i = 0; i < _count; i++)
+            _colors[i] = _makeColor(_rnd, _previous);
+    }
+
+private:
+    QRgb* _colors;
+    int _count;
+    Ori::Random _rnd;
+    QColor _previous;
+    const PaletteModel::ColorMaker& _makeColor;
+};
+
+} // namespace
+
+void PaletteModel::generate(int rows, int cols, const ColorMaker& makeColor)
+{
+    beginResetModel();
+    _rows = rows;
+    _cols = cols;
+    _colors.resize(rows * cols);
+
+    // Blocks are small enough to keep all threads busy until the end,
+    // and large enough to make task overhead negligible
+    const int blockSize = 16384;
+    const quint64 seed = Ori::Random::local().next();
+    QThreadPool pool;
+    QRgb* colors = _colors.data();
+    for (int start = 0, block = 0; start < _colors.size(); start += blockSize, block++)
+        pool.start(new GenerateTask(colors + start, qMin(blockSize, _colors.size() - start), seed, block, makeColor));
+    pool.waitForDone();
+
+    endResetModel();
+}
+
+int PaletteModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _rows;
+}
+
+int PaletteModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _cols;
+}
+
+QVariant PaletteModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+
+    switch (role)
+    {
+    case Qt::BackgroundRole:
+        return QColor(color(index.row(), index.column()));
+
+    case Qt::ToolTipRole:
+    {
+        QColor c(color(index.row(), index.column()));
+        return QString("%1\n%2\n%3").arg(Ori::Color::formatHtml(c), Ori::Color::formatRgb(c), Ori::Color::formatHsl(c));
+    }
+    }
+    return QVariant();
+}
+
+void PaletteDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    auto model = qobject_cast<const PaletteModel*>(index.model());
+    if (!model)
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+    painter->fillRect(option.rect, QColor(model->color(index.row(), index.column())));
+    if (option.state & QStyle::State_Selected)
+    {
+        painter->setPen(option.palette.color(QPalette::Highlight));
+        painter->drawRect(option.rect.adjusted(0, 0, -1, -1));
+    }
+}
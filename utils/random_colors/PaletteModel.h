@@ -0,0 +1,54 @@
+#ifndef PALETTE_MODEL_H
+#define PALETTE_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QColor>
+#include <QStyledItemDelegate>
+#include <QVector>
+
+#include <functional>
+
+namespace Ori {
+class Random;
+}
+
+/// Grid of colors stored as plain QRgb values, tooltips are made only when requested.
+class PaletteModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /// Makes a color, it's called from worker threads. `rnd` is the generator of the current block,
+    /// `previous` is the previous color of the block that the maker can update, it's invalid at the block start.
+    using ColorMaker = std::function<QRgb(Ori::Random& rnd, QColor& previous)>;
+
+    explicit PaletteModel(QObject *parent = nullptr) : QAbstractTableModel(parent) {}
+
+    /// Fills the grid in parallel. Cells are split into flat blocks of 16K cells regardless of rows,
+    /// blocks are generated by worker threads, each with its own generator and previous color,
+    /// so the result depends only on the seed and not on how blocks are distributed among threads.
+    void generate(int rows, int cols, const ColorMaker& makeColor);
+
+    QRgb color(int row, int col) const { return _colors.at(row * _cols + col); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    int _rows = 0, _cols = 0;
+    QVector<QRgb> _colors;
+};
+
+/// Paints cells of PaletteModel as solid color boxes.
+class PaletteDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit PaletteDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
+
+#endif // PALETTE_MODEL_H
@@ -28,6 +28,8 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 
 SOURCES += main.cpp\
-        MainWindow.cpp
+        MainWindow.cpp \
+        PaletteModel.cpp
 
-HEADERS  += MainWindow.h
+HEADERS  += MainWindow.h \
+        PaletteModel.h
@@ -10,9 +10,11 @@ int main(int argc, char* argv[])
     // It is used as settings storage location.
     app.setOrganizationName("orion_examples");
 
-    return Ori::Testing::run(app, {
-        ADD_SUITE(Ori::Tests),
-    });
+    Ori::Testing::TestSuite tests = ADD_SUITE(Ori::Tests);
+    if (Ori::Testing::withBenchmarks())
+        tests.append(ADD_GROUP(Ori::Tests::BenchmarkTests));
+
+    return Ori::Testing::run(app, tests);
 }
 
 
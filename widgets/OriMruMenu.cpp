@@ -7,14 +7,77 @@
 #include <QFileInfo>
 #include <QLabel>
 #include <QMenu>
+#include <QSet>
 
 namespace Ori {
 namespace Widgets {
 
+namespace {
+
+// Bulk changes of a list, e.g. opening of many files at once,
+// result in a single repopulation at the next event loop pass
+void schedule(QObject* target, bool& scheduled)
+{
+    if (scheduled) return;
+    scheduled = true;
+    QMetaObject::invokeMethod(target, "populate", Qt::QueuedConnection);
+}
+
+// Makes the sequence of actions shown in the widget right before the `before` action
+// (or at the end if it's null) equal to the required one. Actions already standing
+// in their places are not touched, so moving an item to top costs just one insertion.
+void updateActions(QWidget* target, QList<QPointer<QAction>>& shown, const QList<QAction*>& required, QAction* before)
+{
+    QSet<QAction*> requiredSet;
+    requiredSet.reserve(required.size());
+    for (QAction* a : required)
+        requiredSet.insert(a);
+
+    QList<QAction*> kept;
+    kept.reserve(shown.size());
+    for (const QPointer<QAction>& a : shown)
+    {
+        if (!a) continue; // deleted by its list
+        if (requiredSet.contains(a))
+            kept.append(a);
+        else
+            target->removeAction(a);
+    }
+
+    // The widget holds the already placed actions followed by the rest of `kept`,
+    // except for those already moved up, they are skipped when reached
+    QSet<QAction*> moved;
+    QList<QPointer<QAction>> placed;
+    placed.reserve(required.size());
+    int pos = 0;
+    for (QAction* a : required)
+    {
+        while (pos < kept.size() && moved.contains(kept.at(pos)))
+            pos++;
+        if (pos < kept.size() && kept.at(pos) == a)
+            pos++;
+        else
+        {
+            target->insertAction(pos < kept.size() ? kept.at(pos) : before, a);
+            moved.insert(a);
+        }
+        placed.append(a);
+    }
+    shown = placed;
+}
+
+} // namespace
+
 MruMenu::MruMenu(const QString& title, MruList *mru, QWidget *parent) : QMenu(title, parent), _mru(mru)
 {
     if (_mru)
-        connect(_mru, SIGNAL(changed()), this, SLOT(populate()));
+    {
+        connect(_mru, SIGNAL(changed()), this, SLOT(schedulePopulate()));
+        connect(this, SIGNAL(aboutToShow()), _mru, SLOT(checkItems()));
+    }
+
+    _separator = new QAction(this);
+    _separator->setSeparator(true);
 
     populate();
 }
@@ -23,22 +86,21 @@ MruMenu::MruMenu(MruList *mru, QWidget *parent) : MruMenu(tr("Recently used"), m
 {
 }
 
+void MruMenu::schedulePopulate()
+{
+    schedule(this, _populateScheduled);
+}
+
 void MruMenu::populate()
 {
-    clear();
+    _populateScheduled = false;
 
-    if (!_mru) return;
+    QList<QAction*> actions;
+    if (_mru && !_mru->actions().isEmpty())
+        actions << _mru->actions() << _separator << _mru->actionClearInvalids() << _mru->actionClearAll();
+    updateActions(this, _shown, actions, nullptr);
 
-    if (!_mru->actions().isEmpty())
-    {
-        for (auto a : _mru->actions()) addAction(a);
-        addSeparator();
-        addAction(_mru->actionClearInvalids());
-        addAction(_mru->actionClearAll());
-        setEnabled(true);
-    }
-    else
-        setEnabled(false);
+    setEnabled(!actions.isEmpty());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -47,7 +109,11 @@ MruMenuPart::MruMenuPart(MruList *mru, QMenu *menu, QAction *placeholder, QWidge
     : QObject(parent), _mru(mru), _menu(menu), _placeholder(placeholder)
 {
     if (_mru)
-        connect(_mru, SIGNAL(changed()), this, SLOT(populate()));
+    {
+        connect(_mru, SIGNAL(changed()), this, SLOT(schedulePopulate()));
+        if (_menu)
+            connect(_menu, SIGNAL(aboutToShow()), _mru, SLOT(checkItems()));
+    }
 
     _separator = new QAction(this);
     _separator->setSeparator(true);
@@ -55,27 +121,21 @@ MruMenuPart::MruMenuPart(MruList *mru, QMenu *menu, QAction *placeholder, QWidge
     populate();
 }
 
+void MruMenuPart::schedulePopulate()
+{
+    schedule(this, _populateScheduled);
+}
+
 void MruMenuPart::populate()
 {
-    if (!_mru || !_menu || !_placeholder) return;
+    _populateScheduled = false;
 
-    for (auto a : _mru->actions()) _menu->removeAction(a);
-    _menu->removeAction(_mru->actionClearAll());
-    _menu->removeAction(_mru->actionClearInvalids());
+    if (!_mru || !_menu || !_placeholder) return;
 
+    QList<QAction*> actions;
     if (!_mru->actions().isEmpty())
-    {
-        _menu->insertAction(_placeholder, _separator);
-        _menu->insertAction(_separator, _mru->actionClearAll());
-        _menu->insertAction(_mru->actionClearAll(), _mru->actionClearInvalids());
-        QAction* place = _mru->actionClearInvalids();
-        for (int i = _mru->actions().size()-1; i >= 0; i--)
-        {
-            auto action = _mru->actions().at(i);
-            _menu->insertAction(place, action);
-            place = action;
-        }
-    }
+        actions << _mru->actions() << _mru->actionClearInvalids() << _mru->actionClearAll() << _separator;
+    updateActions(_menu, _shown, actions, _placeholder);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -83,7 +143,10 @@ void MruMenuPart::populate()
 MruListWidget::MruListWidget(MruList *mru, QWidget *parent) : QWidget(parent), _mru(mru)
 {
     if (_mru)
-        connect(_mru, SIGNAL(changed()), this, SLOT(populate()));
+    {
+        connect(_mru, SIGNAL(changed()), this, SLOT(schedulePopulate()));
+        connect(_mru, SIGNAL(itemStateChanged(QString)), this, SLOT(updateLink(QString)));
+    }
 
     _header = new QLabel;
     setHeader(tr("Recently used"));
@@ -110,20 +173,41 @@ MruListWidget::MruListWidget(MruList *mru, QWidget *parent) : QWidget(parent), _
     populate();
 }
 
+void MruListWidget::schedulePopulate()
+{
+    schedule(this, _populateScheduled);
+}
+
 void MruListWidget::populate()
 {
-    for (auto link : _links.keys()) delete link;
+    _populateScheduled = false;
     _links.clear();
 
-    if (!_mru) return;
+    int count = _mru ? _mru->actions().size() : 0;
 
-    foreach (QAction *action, _mru->actions())
+    // Labels are reused in their places, only their texts are changed,
+    // and unneeded labels are hidden until the list grows again
+    for (int i = 0; i < count; i++)
     {
-        auto link = new QLabel(makeLinkText(action));
-        connect(link, SIGNAL(linkActivated(QString)), this, SLOT(clicked()));
-        _layout->addWidget(link);
+        QAction* action = _mru->actions().at(i);
+        QLabel* link;
+        if (i < _labels.size())
+            link = _labels.at(i);
+        else
+        {
+            link = new QLabel;
+            connect(link, SIGNAL(linkActivated(QString)), this, SLOT(clicked()));
+            _layout->addWidget(link);
+            _labels.append(link);
+        }
+        QString text = makeLinkText(action);
+        if (link->text() != text)
+            link->setText(text);
+        link->setVisible(true);
         _links.insert(link, action);
     }
+    for (int i = count; i < _labels.size(); i++)
+        _labels.at(i)->setVisible(false);
 }
 
 QString MruListWidget::makeLinkText(QAction* action) const
@@ -131,10 +215,21 @@ QString MruListWidget::makeLinkText(QAction* action) const
     return QString("<a href=%1>%1</a>").arg(action->text());
 }
 
+void MruListWidget::updateLink(const QString& item)
+{
+    for (auto it = _links.constBegin(); it != _links.constEnd(); it++)
+        if (it.value() && it.value()->text() == item)
+        {
+            auto link = qobject_cast<QLabel*>(it.key());
+            if (link) link->setText(makeLinkText(it.value()));
+            break;
+        }
+}
+
 void MruListWidget::clicked()
 {
-    if (_links.contains(sender()))
-        _links[sender()]->trigger();
+    QAction* action = _links.value(sender());
+    if (action) action->trigger();
 }
 
 void MruListWidget::setHeader(const QString& s)
@@ -146,8 +241,11 @@ void MruListWidget::setHeader(const QString& s)
 
 QString MruFileListWidget::makeLinkText(QAction* action) const
 {
+    // Only file name is taken here, the file system is not touched,
+    // existence of the file is checked in background by the list
     QFileInfo file(action->text());
-    auto text = file.exists()
+    bool exists = !mru() || mru()->itemState(action->text()) != MruList::ItemInvalid;
+    auto text = exists
         ? QString("<a href=%1>%1</a>").arg(file.baseName())
         : file.baseName();
     return QString("%1<br><font color='%3'>%2</font>").arg(text, file.filePath(), filePathColor());
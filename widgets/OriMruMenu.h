@@ -31,8 +31,12 @@ public:
 
 private:
     QPointer<MruList> _mru;
+    QList<QPointer<QAction>> _shown;
+    QAction *_separator;
+    bool _populateScheduled = false;
 
 private slots:
+    void schedulePopulate();
     void populate();
 };
 
@@ -49,9 +53,12 @@ private:
     QPointer<MruList> _mru;
     QPointer<QMenu> _menu;
     QPointer<QAction> _placeholder;
+    QList<QPointer<QAction>> _shown;
     QAction *_separator;
+    bool _populateScheduled = false;
 
 private slots:
+    void schedulePopulate();
     void populate();
 };
 
@@ -69,15 +76,20 @@ public:
 private:
     QPointer<MruList> _mru;
     QVBoxLayout* _layout;
-    QMap<QObject*, QAction*> _links;
+    QList<QLabel*> _labels;
+    QMap<QObject*, QPointer<QAction>> _links;
     QLabel* _header;
+    bool _populateScheduled = false;
 
 protected:
+    MruList* mru() const { return _mru; }
     virtual QString makeLinkText(QAction* action) const;
 
 private slots:
     void clicked();
+    void schedulePopulate();
     void populate();
+    void updateLink(const QString& item);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1,5 +1,6 @@
 #include "OriSelectableTile.h"
 
+#include "../helpers/OriTheme.h"
 #include "../helpers/OriTools.h"
 
 #include <QDebug>
@@ -56,6 +57,14 @@ void SelectableTile::setTitleStyleSheet(const QString& styleSheet)
     _titleLabel->setStyleSheet(styleSheet);
 }
 
+void SelectableTile::setTitleColor(const QColor& color)
+{
+    if (color.isValid())
+        Theme::setColors(_titleLabel, color);
+    else
+        Theme::resetColors(_titleLabel);
+}
+
 
 void SelectableTile::setData(const QVariant& data)
 {
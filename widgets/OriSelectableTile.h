@@ -23,6 +23,9 @@ public:
     void setTitle(const QString& title);
     void setTitleStyleSheet(const QString& styleSheet);
 
+    /// Sets color of the title via palette, it's cheaper than setTitleStyleSheet.
+    void setTitleColor(const QColor& color);
+
     QVariant data() const { return _data; }
     void setData(const QVariant& data);
 
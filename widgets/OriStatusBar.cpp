@@ -1,6 +1,8 @@
 #include "OriStatusBar.h"
 #include "OriLabels.h"
+#include "../helpers/OriTheme.h"
 
+#include <QApplication>
 #include <QIcon>
 
 namespace Ori {
@@ -60,14 +62,58 @@ void StatusBar::connect(int index, const char *signal, const QObject *receiver,
     QStatusBar::connect(_sections[index], signal, receiver, method);
 }
 
+// Highlighting is switched often, so it's done via palette when possible,
+// stylesheet would install stylesheet style and repolish the label each time.
+// But rules of the application stylesheet override palette colors, so then
+// the label gets its own stylesheet, which takes precedence over the application one.
 void StatusBar::highlightError(int index)
 {
-    _sections[index]->setStyleSheet("QLabel{background:red;color:white;font-weight:bold}");
+    if (_highlighted.contains(index)) return;
+
+    auto label = _sections[index];
+    QColor text = Theme::color(QStringLiteral("$error-text"), Qt::white);
+    QColor background = Theme::color(QStringLiteral("$error-background"), Qt::red);
+
+    SavedLook look;
+    look.byStyleSheet = !qApp->styleSheet().isEmpty();
+    if (look.byStyleSheet)
+    {
+        look.styleSheet = label->styleSheet();
+        _highlighted.insert(index, look);
+        label->setStyleSheet(QStringLiteral("QLabel{background:%1;color:%2;font-weight:bold}")
+            .arg(background.name(), text.name()));
+        return;
+    }
+
+    // Default-constructed palette and font are restored when the label inherits them,
+    // so it keeps following changes of the parent (e.g. when the style is switched)
+    look.palette = label->testAttribute(Qt::WA_SetPalette) ? label->palette() : QPalette();
+    look.font = label->testAttribute(Qt::WA_SetFont) ? label->font() : QFont();
+    look.autoFillBackground = label->autoFillBackground();
+    _highlighted.insert(index, look);
+
+    Theme::setColors(label, text, background);
+    QFont font = label->font();
+    font.setBold(true);
+    label->setFont(font);
 }
 
 void StatusBar::highlightReset(int index)
 {
-    _sections[index]->setStyleSheet(QString());
+    auto it = _highlighted.find(index);
+    if (it == _highlighted.end()) return;
+
+    auto label = _sections[index];
+    if (it->byStyleSheet)
+    {
+        label->setStyleSheet(it->styleSheet);
+        _highlighted.erase(it);
+        return;
+    }
+    label->setAutoFillBackground(it->autoFillBackground);
+    label->setPalette(it->palette);
+    label->setFont(it->font);
+    _highlighted.erase(it);
 }
 
 void StatusBar::setIconSize(const QSize& size)
@@ -1,6 +1,7 @@
 #ifndef ORI_STATUS_BAR_H
 #define ORI_STATUS_BAR_H
 
+#include <QMap>
 #include <QStatusBar>
 
 QT_BEGIN_NAMESPACE
@@ -32,7 +33,12 @@ public:
     void clear(int index);
     void clear();
 
+    /// Highlights the section with error colors and bold font.
+    /// They are set through the palette, or through the label stylesheet
+    /// when the application has a stylesheet, because its rules override palette colors.
     void highlightError(int index);
+
+    /// Restores the font, palette or stylesheet the section had before highlighting.
     void highlightReset(int index);
 
     void setIconSize(const QSize& size);
@@ -42,6 +48,16 @@ public:
 private:
     QVector<QLabel*> _sections;
     QSize _iconSize;
+
+    struct SavedLook
+    {
+        bool byStyleSheet = false;
+        QString styleSheet;
+        QPalette palette;
+        QFont font;
+        bool autoFillBackground = false;
+    };
+    QMap<int, SavedLook> _highlighted;
 };
 
 } // namespace Widgets
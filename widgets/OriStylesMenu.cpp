@@ -27,7 +27,8 @@ void StylesMenu::populate()
 
 void StylesMenu::applyStyle()
 {
-    _styler->setCurrentStyle(qobject_cast<QAction*>(sender())->text());
+    // Only visible widgets are restyled at once, so the menu responds instantly
+    _styler->setCurrentStyle(qobject_cast<QAction*>(sender())->text(), Styler::Staged);
 }
 
 void StylesMenu::highlightCurrentStyle()